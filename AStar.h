@@ -0,0 +1,475 @@
+//---------------------------------------------------------------------------------------------------------
+//  Целенаправленный поиск: A* с подключаемой эвристикой и ALT (A*, Landmarks, Triangle inequality).
+//
+//  A* - тот же алгоритм Дейкстры, но очередь упорядочена по ключу key = weight + h(v), где h(v) -
+//  нижняя оценка расстояния от v до финиша. Чем точнее оценка, тем меньше вершин приходится закрывать.
+//  Эвристика - любой объект с операцией h(v, finish), возвращающей допустимую (не завышенную) оценку.
+//  Если эвристика не согласована, закрытые вершины переоткрываются, так что ответ остаётся точным.
+//
+//  Координат у вершин нет, поэтому для ALT заранее выбираются K опорных вершин (landmarks) и для каждой
+//  считаются расстояния от неё до всех вершин и от всех вершин до неё. По неравенству треугольника
+//      d(v, t) >= d(L, t) - d(L, v)   и   d(v, t) >= d(v, L) - d(t, L),
+//  максимум по опорным вершинам даёт эвристику. Таблицы можно сохранить рядом с файлом графа.
+//---------------------------------------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <string>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+#include "Dijkstra.h"
+#include "CSRGraph.h"
+
+//  Обёртка вершины для A* - к полям graphVertex добавляется ключ очереди
+template<typename vertexType>
+struct astarVertex : graphVertex<vertexType> {
+	using weight_type = typename graphVertex<vertexType>::weight_type;
+
+	//  weight + h(v) - именно по нему упорядочена очередь
+	weight_type key;
+
+	explicit astarVertex(const vertexType& vert) noexcept :
+		graphVertex<vertexType>(vert),
+		key(std::numeric_limits<weight_type>::max())
+	{}
+
+	inline bool operator<(const astarVertex<vertexType>& other) const { return key < other.key; }
+	inline bool operator>(const astarVertex<vertexType>& other) const { return key > other.key; }
+};
+
+//  Нулевая эвристика - A* с ней превращается в обычный алгоритм Дейкстры
+struct zeroHeuristic {
+	template<typename size_type>
+	inline size_t operator()(size_type, size_type) const noexcept { return 0; }
+};
+
+//  Адаптер для A*. Требования к графу те же, что в Dijkstra.h
+template<typename vertexType, typename heuristicType = zeroHeuristic>
+class AStar {
+private:
+
+	//  Типы для индексов и весов
+	using size_type = typename graphVertex<vertexType>::size_type;
+	using weight_type = typename graphVertex<vertexType>::weight_type;
+
+	using nodeType = astarVertex<vertexType>;
+	using queueElemType = queueElem<nodeType>;
+
+	std::vector<nodeType> nodes;
+	ExtPriority_Queue<nodeType, std::vector<queueElemType>, std::greater<queueElemType>> epq;
+
+	//  Затронутые прошлым запросом вершины
+	std::vector<size_type> touched;
+
+	heuristicType heuristic;
+
+	//  Количество закрытых вершин в последнем запросе
+	size_type settled = 0;
+
+	void reset() noexcept {
+		for (size_type index : touched) {
+			nodes[index].parent = std::numeric_limits<size_type>::max();
+			nodes[index].weight = std::numeric_limits<weight_type>::max();
+			nodes[index].key = std::numeric_limits<weight_type>::max();
+			nodes[index].state = vertexState::None;
+			nodes[index].index = std::numeric_limits<size_type>::max();
+		}
+		touched.clear();
+		epq.clear();
+		settled = 0;
+	}
+
+public:
+	//  Конструктор - цепляется к существующему графу, эвристика передаётся объектом
+	template<typename vertexCont>
+	explicit AStar(const vertexCont& cont, heuristicType Heuristic = heuristicType()) : heuristic(Heuristic) {
+		for (auto it = cont.cbegin(); it != cont.cend(); ++it)
+			nodes.push_back(nodeType(*it));
+	}
+
+	size_type settledCount() const noexcept { return settled; }
+
+	//  Поиск пути - результат такой же, как у Dijkstra::calcPath
+	std::pair<std::vector<size_type>, weight_type> calcPath(size_type startIndex, size_type finishIndex) {
+		if (startIndex >= nodes.size() || finishIndex >= nodes.size())
+			throw std::out_of_range("Wrong start or finish node index!");
+
+		reset();
+
+		nodes[startIndex].parent = startIndex;
+		nodes[startIndex].weight = 0;
+		nodes[startIndex].key = heuristic(startIndex, finishIndex);
+		nodes[startIndex].state = vertexState::Opened;
+		touched.push_back(startIndex);
+		epq.push(nodes[startIndex]);
+
+		while (!epq.empty()) {
+			const nodeType& current(epq.top());
+			epq.pop();
+
+			size_type currentIndex = current.vertex->name;
+
+			//  Эвристика допустима, поэтому финиш, извлечённый из очереди, имеет точную оценку
+			if (currentIndex == finishIndex) {
+				std::vector<size_type> path;
+				size_type nodeIndex(finishIndex);
+				path.push_back(nodeIndex);
+				while (nodeIndex != startIndex) {
+					nodeIndex = nodes[nodeIndex].parent;
+					path.push_back(nodeIndex);
+				}
+				std::reverse(path.begin(), path.end());
+				return make_pair(path, current.weight);
+			}
+
+			nodes[currentIndex].state = vertexState::Finished;
+			++settled;
+
+			for (auto adjIt = current.vertex->cbegin(); adjIt != current.vertex->cend(); ++adjIt) {
+				nodeType& next = nodes[adjIt->dest];
+				weight_type candidate = current.weight + adjIt->weight;
+
+				if (next.state == vertexState::None) {
+					weight_type h = heuristic(adjIt->dest, finishIndex);
+					//  Бесконечная оценка - из этой вершины до финиша не добраться
+					if (h == std::numeric_limits<weight_type>::max()) continue;
+					next.state = vertexState::Opened;
+					next.parent = currentIndex;
+					next.weight = candidate;
+					next.key = candidate + h;
+					touched.push_back(adjIt->dest);
+					epq.push(next);
+				}
+				else if (next.weight > candidate) {
+					//  Ключ = вес + эвристика, разность key - weight и есть h(v), пересчитывать не нужно
+					weight_type h = next.key - next.weight;
+					next.weight = candidate;
+					next.key = candidate + h;
+					next.parent = currentIndex;
+					if (next.state == vertexState::Finished) {
+						//  Несогласованная эвристика - вершину приходится открывать заново
+						next.state = vertexState::Opened;
+						epq.push(next);
+					}
+					else
+						epq.decreaseKey(next.index);
+				}
+			}
+		}
+		//  Пути не существует
+		return make_pair(std::vector<size_type>(), weight_type(0));
+	}
+};
+
+//---------------------------------------------------------------------------------------------------------
+//  Опорные вершины для ALT и таблицы расстояний до них
+
+//  Способ выбора опорных вершин
+enum class landmarkSelection { Farthest, Avoid };
+
+class landmarks {
+public:
+	using size_type = csrGraph::size_type;
+	using weight_type = csrGraph::weight_type;
+
+	static constexpr weight_type infinity = std::numeric_limits<weight_type>::max();
+
+	landmarks() = default;
+
+	//  Предобработка: выбираем K опорных вершин и считаем таблицы расстояний
+	template<typename vertexCont>
+	landmarks(const vertexCont& cont, size_type K, landmarkSelection method = landmarkSelection::Avoid, unsigned seed = 1) {
+		build(cont, K, method, seed);
+	}
+
+	template<typename vertexCont>
+	void build(const vertexCont& cont, size_type K, landmarkSelection method = landmarkSelection::Avoid, unsigned seed = 1) {
+		const csrGraph forward(cont);
+		const csrGraph reverse = csrGraph::transposed(cont);
+
+		vertexCount = forward.size();
+		ids.clear();
+		K = std::min(K, vertexCount);
+		columns = K;
+		forwardDist.assign(vertexCount * K, infinity);
+		backwardDist.assign(vertexCount * K, infinity);
+		if (K == 0) return;
+
+		std::mt19937 generator(seed);
+		std::vector<weight_type> dist, reverseDist;
+		std::vector<size_type> parent, order;
+
+		//  Для "дальней точки" - минимальное расстояние от уже выбранных опорных вершин
+		std::vector<weight_type> nearest(vertexCount, infinity);
+
+		for (size_type i = 0; i < K; ++i) {
+			size_type next;
+			if (ids.empty()) {
+				//  Первая опорная вершина - самая дальняя от случайной
+				shortestTree(forward, generator() % vertexCount, dist, parent, order);
+				next = order.back();
+			}
+			else if (method == landmarkSelection::Avoid)
+				next = avoidCandidate(forward, generator() % vertexCount, nearest, dist, parent, order);
+			else
+				next = farthestCandidate(nearest);
+
+			if (std::find(ids.begin(), ids.end(), next) != ids.end())
+				next = farthestCandidate(nearest);
+			if (std::find(ids.begin(), ids.end(), next) != ids.end())
+				break;
+
+			//  Таблицы: d(L, v) по прямому графу и d(v, L) - по обращённому
+			shortestTree(forward, next, dist, parent, order);
+			shortestTree(reverse, next, reverseDist, parent, order);
+			for (size_type v = 0; v < vertexCount; ++v) {
+				forwardDist[v * K + i] = dist[v];
+				backwardDist[v * K + i] = reverseDist[v];
+				if (dist[v] != infinity && reverseDist[v] != infinity)
+					nearest[v] = std::min(nearest[v], std::max(dist[v], reverseDist[v]));
+				else if (nearest[v] == infinity)
+					nearest[v] = 0;
+			}
+			ids.push_back(next);
+		}
+
+		//  Если различных вершин не хватило, то ужимаем таблицы до фактического количества
+		if (ids.size() < K) {
+			size_type count = ids.size();
+			for (size_type v = 0; v < vertexCount; ++v)
+				for (size_type i = 0; i < count; ++i) {
+					forwardDist[v * count + i] = forwardDist[v * K + i];
+					backwardDist[v * count + i] = backwardDist[v * K + i];
+				}
+			forwardDist.resize(vertexCount * count);
+			backwardDist.resize(vertexCount * count);
+			columns = count;
+		}
+	}
+
+	size_type count() const noexcept { return ids.size(); }
+	size_type size() const noexcept { return vertexCount; }
+	const std::vector<size_type>& vertices() const noexcept { return ids; }
+
+	//  Нижняя оценка d(v, t) по неравенству треугольника. Строки таблиц хранятся по вершинам,
+	//  так что для одной вершины все K расстояний лежат рядом
+	weight_type lowerBound(size_type v, size_type t) const noexcept {
+		const size_type K = ids.size();
+		const weight_type* fromV = &forwardDist[v * columns];
+		const weight_type* fromT = &forwardDist[t * columns];
+		const weight_type* toV = &backwardDist[v * columns];
+		const weight_type* toT = &backwardDist[t * columns];
+
+		weight_type best = 0;
+		for (size_type i = 0; i < K; ++i) {
+			//  d(L, t) - d(L, v)
+			if (fromT[i] != infinity && fromV[i] != infinity && fromT[i] > fromV[i])
+				best = std::max(best, fromT[i] - fromV[i]);
+			//  d(v, L) - d(t, L)
+			if (toV[i] != infinity && toT[i] != infinity && toV[i] > toT[i])
+				best = std::max(best, toV[i] - toT[i]);
+		}
+		return best;
+	}
+
+	//  Сохранение таблиц - двоичный файл, который удобно положить рядом с файлом графа
+	void saveToFile(std::string filename) const {
+		std::ofstream out(filename, std::ios_base::out | std::ios_base::binary);
+		if (!out)
+			throw std::runtime_error("Can't create landmarks file " + filename);
+		out.write(signature, sizeof(signature));
+		writeValue(out, static_cast<std::uint64_t>(vertexCount));
+		writeValue(out, static_cast<std::uint64_t>(ids.size()));
+		for (size_type id : ids)
+			writeValue(out, static_cast<std::uint64_t>(id));
+		for (weight_type w : forwardDist)
+			writeValue(out, static_cast<std::uint64_t>(w));
+		for (weight_type w : backwardDist)
+			writeValue(out, static_cast<std::uint64_t>(w));
+		out.close();
+	}
+
+	void loadFromFile(std::string filename) {
+		std::ifstream in(filename, std::ios_base::in | std::ios_base::binary);
+		if (!in)
+			throw std::runtime_error("Can't open landmarks file " + filename);
+		char header[sizeof(signature)];
+		in.read(header, sizeof(header));
+		if (!in || !std::equal(header, header + sizeof(header), signature))
+			throw std::runtime_error("Wrong landmarks file format: " + filename);
+
+		vertexCount = static_cast<size_type>(readValue(in));
+		size_type K = static_cast<size_type>(readValue(in));
+		columns = K;
+		ids.resize(K);
+		for (size_type& id : ids)
+			id = static_cast<size_type>(readValue(in));
+		forwardDist.resize(vertexCount * K);
+		backwardDist.resize(vertexCount * K);
+		for (weight_type& w : forwardDist)
+			w = static_cast<weight_type>(readValue(in));
+		for (weight_type& w : backwardDist)
+			w = static_cast<weight_type>(readValue(in));
+		if (!in)
+			throw std::runtime_error("Landmarks file is truncated: " + filename);
+	}
+
+	//  Загружаем таблицы, если файл есть и подходит к графу, иначе строим и сохраняем
+	template<typename vertexCont>
+	void loadOrBuild(const vertexCont& cont, size_type K, std::string filename,
+		landmarkSelection method = landmarkSelection::Avoid) {
+		if (std::ifstream(filename)) {
+			loadFromFile(filename);
+			size_type Size = 0;
+			for (auto it = cont.cbegin(); it != cont.cend(); ++it)
+				++Size;
+			if (Size == vertexCount && ids.size() == K)
+				return;
+		}
+		build(cont, K, method);
+		saveToFile(filename);
+	}
+
+private:
+	static constexpr char signature[4] = { 'A', 'L', 'T', '1' };
+
+	size_type vertexCount = 0;
+	std::vector<size_type> ids;
+	//  Ширина строки таблиц (во время построения опорных вершин ещё меньше, чем строк)
+	size_type columns = 0;
+	//  forwardDist[v * K + i] = d(L_i, v),  backwardDist[v * K + i] = d(v, L_i)
+	std::vector<weight_type> forwardDist;
+	std::vector<weight_type> backwardDist;
+
+	static void writeValue(std::ofstream& out, std::uint64_t value) {
+		out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+	static std::uint64_t readValue(std::ifstream& in) {
+		std::uint64_t value = 0;
+		in.read(reinterpret_cast<char*>(&value), sizeof(value));
+		return value;
+	}
+
+	//  Полный алгоритм Дейкстры из source: расстояния, родители и порядок закрытия вершин
+	static void shortestTree(const csrGraph& g, size_type source, std::vector<weight_type>& dist,
+		std::vector<size_type>& parent, std::vector<size_type>& order) {
+		using nodeType = graphVertex<csrVertex>;
+		using queueElemType = queueElem<nodeType>;
+
+		std::vector<nodeType> nodes;
+		nodes.reserve(g.size());
+		for (auto it = g.cbegin(); it != g.cend(); ++it)
+			nodes.push_back(nodeType(*it));
+
+		ExtPriority_Queue<nodeType, std::vector<queueElemType>, std::greater<queueElemType>> epq;
+		order.clear();
+		nodes[source].parent = source;
+		nodes[source].weight = 0;
+		nodes[source].state = vertexState::Opened;
+		epq.push(nodes[source]);
+
+		while (!epq.empty()) {
+			const nodeType& current(epq.top());
+			epq.pop();
+			size_type currentIndex = current.vertex->name;
+			nodes[currentIndex].state = vertexState::Finished;
+			order.push_back(currentIndex);
+
+			for (auto adjIt = current.vertex->cbegin(); adjIt != current.vertex->cend(); ++adjIt) {
+				nodeType& next = nodes[adjIt->dest];
+				if (next.state == vertexState::None) {
+					next.state = vertexState::Opened;
+					next.parent = currentIndex;
+					next.weight = current.weight + adjIt->weight;
+					epq.push(next);
+				}
+				else if (next.state != vertexState::Finished && next.weight > current.weight + adjIt->weight) {
+					next.weight = current.weight + adjIt->weight;
+					next.parent = currentIndex;
+					epq.decreaseKey(next.index);
+				}
+			}
+		}
+
+		dist.resize(nodes.size());
+		parent.resize(nodes.size());
+		for (size_type v = 0; v < nodes.size(); ++v) {
+			dist[v] = nodes[v].weight;
+			parent[v] = nodes[v].parent;
+		}
+	}
+
+	//  Вершина, максимально удалённая от уже выбранных опорных
+	size_type farthestCandidate(const std::vector<weight_type>& nearest) const {
+		size_type best = 0;
+		for (size_type v = 0; v < vertexCount; ++v)
+			if (nearest[v] != infinity && (nearest[best] == infinity || nearest[v] > nearest[best]))
+				best = v;
+		return best;
+	}
+
+	//  Эвристика "avoid": в дереве кратчайших путей из случайного корня ищем поддерево, где текущие
+	//  опорные вершины дают самую плохую оценку, и спускаемся по нему до листа
+	size_type avoidCandidate(const csrGraph& g, size_type root, const std::vector<weight_type>& nearest,
+		std::vector<weight_type>& dist, std::vector<size_type>& parent, std::vector<size_type>& order) const {
+		shortestTree(g, root, dist, parent, order);
+
+		//  Вес вершины - насколько оценка из корня хуже точного расстояния. Копим по поддеревьям
+		//  в порядке, обратном порядку закрытия (потомки закрываются позже родителей).
+		//  Поддеревья, в которых уже есть опорная вершина, получают нулевой размер
+		std::vector<weight_type> size(vertexCount, 0);
+		std::vector<char> hasLandmark(vertexCount, 0);
+		for (size_type id : ids)
+			hasLandmark[id] = 1;
+		for (auto it = order.rbegin(); it != order.rend(); ++it) {
+			size_type v = *it;
+			if (hasLandmark[v])
+				size[v] = 0;
+			else
+				size[v] += dist[v] - std::min(dist[v], lowerBound(root, v));
+			if (v != root) {
+				if (hasLandmark[v])
+					hasLandmark[parent[v]] = 1;
+				size[parent[v]] += size[v];
+			}
+		}
+		//  Дети каждой вершины в дереве - в виде CSR, как и всё остальное
+		std::vector<size_type> first(vertexCount + 1, 0), children(order.size());
+		for (size_type v : order)
+			if (v != root) ++first[parent[v] + 1];
+		for (size_type v = 0; v < vertexCount; ++v)
+			first[v + 1] += first[v];
+		std::vector<size_type> pos(first.begin(), first.end() - 1);
+		for (size_type v : order)
+			if (v != root) children[pos[parent[v]]++] = v;
+
+		size_type v = root;
+		while (true) {
+			size_type next = v;
+			for (size_type c = first[v]; c < first[v + 1]; ++c)
+				if (size[children[c]] > 0 && (next == v || size[children[c]] > size[next]))
+					next = children[c];
+			if (next == v) break;
+			v = next;
+		}
+		//  Плохих поддеревьев нет - берём просто самую дальнюю вершину
+		return v == root ? farthestCandidate(nearest) : v;
+	}
+};
+
+//  Эвристика ALT для AStar - хранит только ссылку на таблицы опорных вершин
+class altHeuristic {
+public:
+	explicit altHeuristic(const landmarks& Landmarks) noexcept : table(&Landmarks) {}
+
+	inline landmarks::weight_type operator()(landmarks::size_type v, landmarks::size_type finish) const noexcept {
+		return table->lowerBound(v, finish);
+	}
+
+private:
+	const landmarks* table;
+};
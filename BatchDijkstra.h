@@ -0,0 +1,223 @@
+//---------------------------------------------------------------------------------------------------------
+//  Пакетная обработка независимых запросов "из точки в точку" в несколько потоков.
+//
+//  Граф только читается, поэтому запросы к нему можно выполнять параллельно - нужно лишь, чтобы у каждого
+//  потока было собственное состояние поиска. BatchDijkstra создаёт по одному объекту Dijkstra на поток
+//  (обёртки вершин, очередь, список затронутых вершин) один раз и переиспользует их между пакетами, так что
+//  на запрос память выделяется только под возвращаемый путь. Потоки тоже живут всё время жизни объекта:
+//  между пакетами они ждут на условной переменной, а поток, вызвавший calcPaths, работает как поток 0.
+//
+//  Распределение работы - с перехватом (work stealing): каждому потоку достаётся непрерывный диапазон
+//  запросов, поток забирает из его начала порции по grain запросов. Освободившийся поток отнимает у
+//  другого вторую половину оставшегося диапазона. Так запросы разной стоимости не оставляют потоки без
+//  дела в конце пакета, а соседние запросы обычно выполняются одним потоком.
+//
+//  Использование:
+//    BatchDijkstra<vertex> batch(G, 8);
+//    std::vector<BatchDijkstra<vertex>::result> results(queries.size());
+//    batch.calcPaths(queries.data(), queries.size(), results.data());
+//---------------------------------------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+#include "Dijkstra.h"
+
+template<typename vertexType, template<typename> class queuePolicy = binaryHeapQueue>
+class BatchDijkstra {
+public:
+	using size_type = typename graphVertex<vertexType>::size_type;
+	using weight_type = typename graphVertex<vertexType>::weight_type;
+
+	//  Запрос - пара (старт, финиш), результат - как у Dijkstra::calcPath
+	using query = std::pair<size_type, size_type>;
+	using result = std::pair<std::vector<size_type>, weight_type>;
+
+	//  threads == 0 - по количеству аппаратных потоков
+	template<typename vertexCont>
+	explicit BatchDijkstra(const vertexCont& cont, unsigned threads = 0) {
+		if (threads == 0)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		engines.reserve(threads);
+		for (unsigned t = 0; t < threads; ++t)
+			engines.emplace_back(cont);
+		for (unsigned t = 1; t < threads; ++t)
+			pool.emplace_back([this, t] { serve(t); });
+	}
+
+	//  Потоки держат указатель на объект - копировать нельзя
+	BatchDijkstra(const BatchDijkstra&) = delete;
+	BatchDijkstra& operator=(const BatchDijkstra&) = delete;
+
+	~BatchDijkstra() {
+		{
+			std::lock_guard<std::mutex> lock(jobLock);
+			stopping = true;
+		}
+		jobReady.notify_all();
+		for (std::thread& th : pool)
+			th.join();
+	}
+
+	unsigned threads() const noexcept { return static_cast<unsigned>(engines.size()); }
+
+	//  Выполнить count запросов, результаты пишутся в results[0..count) (буфер выделяет вызывающий).
+	//  Если какой-то запрос некорректен, исключение пробрасывается после завершения всех потоков
+	void calcPaths(const query* queries, size_type count, result* results) {
+		parallelRun(count, [queries, results](Dijkstra<vertexType, queuePolicy>& dk, size_type i) {
+			results[i] = dk.calcPath(queries[i].first, queries[i].second);
+		});
+	}
+
+	//  То же для вектора запросов - результаты возвращаются в новом векторе
+	std::vector<result> calcPaths(const std::vector<query>& queries) {
+		std::vector<result> results(queries.size());
+		calcPaths(queries.data(), queries.size(), results.data());
+		return results;
+	}
+
+	//  Таблица расстояний "многие ко многим" (по строкам, как Dijkstra::distanceTable) -
+	//  строки считаются параллельно, каждая одним поиском "один ко многим"
+	std::vector<weight_type> distanceTable(const std::vector<size_type>& sources, const std::vector<size_type>& targets) {
+		std::vector<weight_type> table(sources.size() * targets.size());
+		parallelRun(sources.size(), [&](Dijkstra<vertexType, queuePolicy>& dk, size_type i) {
+			std::vector<weight_type> row(dk.calcDistances(sources[i], targets));
+			std::copy(row.begin(), row.end(), table.begin() + i * targets.size());
+		});
+		return table;
+	}
+
+private:
+	std::vector<Dijkstra<vertexType, queuePolicy>> engines;
+
+	//  Потоки 1..T-1: jobNumber растёт с каждым пакетом, finished - сколько из них закончили текущий
+	std::vector<std::thread> pool;
+	std::function<void(unsigned)> job;
+	std::mutex jobLock;
+	std::condition_variable jobReady;
+	std::condition_variable jobDone;
+	size_t jobNumber = 0;
+	size_t finished = 0;
+	bool stopping = false;
+
+	void serve(unsigned t) {
+		size_t seen = 0;
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(jobLock);
+				jobReady.wait(lock, [this, seen] { return stopping || jobNumber != seen; });
+				if (stopping) return;
+				seen = jobNumber;
+			}
+			job(t);
+			{
+				std::lock_guard<std::mutex> lock(jobLock);
+				++finished;
+			}
+			jobDone.notify_one();
+		}
+	}
+
+	//  Оставшийся диапазон запросов потока. Выравнивание - чтобы соседние диапазоны не делили строку кэша
+	struct alignas(64) workRange {
+		std::mutex lock;
+		size_type begin = 0;
+		size_type end = 0;
+	};
+
+	//  Выполнить task(engine, i) для всех i из [0, count) с перехватом работы между потоками
+	template<typename taskType>
+	void parallelRun(size_type count, taskType task) {
+		unsigned workers = static_cast<unsigned>(std::min<size_type>(engines.size(), count));
+		if (workers == 0) return;
+
+		//  Порция - достаточно мелкая для балансировки и достаточно крупная, чтобы редко брать блокировку
+		size_type grain = std::max<size_type>(1, std::min<size_type>(64, count / (size_type(workers) * 16)));
+
+		std::vector<workRange> ranges(workers);
+		for (unsigned t = 0; t < workers; ++t) {
+			ranges[t].begin = count * t / workers;
+			ranges[t].end = count * (t + 1) / workers;
+		}
+
+		std::atomic<bool> failed(false);
+		std::exception_ptr error;
+		std::mutex errorLock;
+
+		auto worker = [&](unsigned self) {
+			if (self >= workers) return;
+			Dijkstra<vertexType, queuePolicy>& dk = engines[self];
+			size_type first, last;
+			try {
+				while (!failed && (takeOwn(ranges[self], grain, first, last) || steal(ranges, self, grain, first, last)))
+					for (size_type i = first; i < last && !failed; ++i)
+						task(dk, i);
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> guard(errorLock);
+				if (!error) error = std::current_exception();
+				failed = true;
+			}
+		};
+
+		//  Один поток - без пробуждения остальных
+		if (workers == 1)
+			worker(0);
+		else {
+			{
+				std::lock_guard<std::mutex> lock(jobLock);
+				job = worker;
+				finished = 0;
+				++jobNumber;
+			}
+			jobReady.notify_all();
+			worker(0);
+			std::unique_lock<std::mutex> lock(jobLock);
+			jobDone.wait(lock, [this] { return finished == pool.size(); });
+			job = nullptr;
+		}
+
+		if (error)
+			std::rethrow_exception(error);
+	}
+
+	//  Порция из начала собственного диапазона
+	static bool takeOwn(workRange& own, size_type grain, size_type& first, size_type& last) {
+		std::lock_guard<std::mutex> guard(own.lock);
+		if (own.begin == own.end) return false;
+		first = own.begin;
+		last = std::min(own.end, own.begin + grain);
+		own.begin = last;
+		return true;
+	}
+
+	//  Собственный диапазон пуст - забираем вторую половину чужого. Маленький остаток забирается целиком.
+	//  Украденное, кроме первой порции, кладём в свой диапазон, чтобы его могли украсть другие
+	static bool steal(std::vector<workRange>& ranges, unsigned self, size_type grain, size_type& first, size_type& last) {
+		unsigned workers = static_cast<unsigned>(ranges.size());
+		for (unsigned shift = 1; shift < workers; ++shift) {
+			workRange& victim = ranges[(self + shift) % workers];
+			size_type from, to;
+			{
+				std::lock_guard<std::mutex> guard(victim.lock);
+				if (victim.begin == victim.end) continue;
+				to = victim.end;
+				from = to - victim.begin <= grain ? victim.begin : victim.begin + (to - victim.begin) / 2;
+				victim.end = from;
+			}
+			first = from;
+			last = std::min(to, from + grain);
+			std::lock_guard<std::mutex> guard(ranges[self].lock);
+			ranges[self].begin = last;
+			ranges[self].end = to;
+			return true;
+		}
+		return false;
+	}
+};
@@ -0,0 +1,305 @@
+//---------------------------------------------------------------------------------------------------------
+//  Воспроизводимый бенчмарк поиска кратчайших путей.
+//
+//  Для каждого семейства графов и размера генерируется граф (GraphGenerators.h) и набор случайных
+//  запросов - всё от одного зерна, так что повторный запуск даёт те же графы и те же запросы.
+//  Каждый движок отвечает на одинаковые запросы; выводятся время подготовки, перцентили задержки
+//  запроса, закрытые вершины в секунду, пиковый RSS процесса и контрольная сумма стоимостей путей
+//  (у всех точных движков она должна совпадать). Если на каком-то графе контрольные суммы или
+//  количество недостижимых пар у движков разошлись, бенчмарк сообщает об этом и возвращает 1.
+//
+//  Движки rcm, degree и partition - csr4 на графе, перенумерованном для локальности (GraphReordering.h);
+//  время перенумерации входит во время подготовки и выводится отдельно (reorder_s), выигрыш по запросам
+//  виден при сравнении с csr4 на том же графе.
+//
+//  Параметры:
+//    --families random,grid,road,rmat   семейства графов
+//    --edges 1e4,1e5                    приблизительные размеры графов в рёбрах (до 1e8)
+//    --queries 1000                     количество запросов на граф
+//    --engines dijkstra,csr4,auto,bidir,alt   движки (ещё есть compact, simd, rcm, degree, partition, ch и delta)
+//    --threads 0                        потоки для delta-stepping (0 - все ядра)
+//    --seed 1                           зерно генераторов и запросов
+//    --format text|json                 json - по объекту на строку (JSON Lines)
+//---------------------------------------------------------------------------------------------------------
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <random>
+#include "Graph.h"
+#include "GraphGenerators.h"
+#include "Dijkstra.h"
+#include "CSRGraph.h"
+#include "DAryHeap.h"
+#include "MonotoneQueues.h"
+#include "BiDijkstra.h"
+#include "AStar.h"
+#include "ContractionHierarchies.h"
+#include "DeltaStepping.h"
+#include "GraphReordering.h"
+#include "SimdDijkstra.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+using benchClock = chrono::steady_clock;
+using query = pair<vertex::size_type, vertex::size_type>;
+
+//  Пиковый объём резидентной памяти процесса в килобайтах
+static size_t peakRssKB() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize / 1024;
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+static double secondsSince(benchClock::time_point start) {
+    return chrono::duration<double>(benchClock::now() - start).count();
+}
+
+//  Результаты одного движка на одном графе
+struct measurement {
+    string engine;
+    double buildSeconds = 0;
+    double reorderSeconds = -1;     //  отрицательное - граф не перенумеровывался
+    vector<double> latencies;       //  микросекунды
+    unsigned long long settled = 0;
+    bool hasSettled = true;
+    unsigned long long checksum = 0;
+    size_t unreachable = 0;
+};
+
+//  Прогон всех запросов; settledOf достаёт из движка количество закрытых вершин последнего запроса
+template<typename engineType, typename settledFunc>
+void runQueries(measurement& m, engineType& engine, const vector<query>& queries, settledFunc settledOf) {
+    m.latencies.reserve(queries.size());
+    for (const query& q : queries) {
+        auto start = benchClock::now();
+        auto result = engine.calcPath(q.first, q.second);
+        m.latencies.push_back(secondsSince(start) * 1e6);
+        m.settled += settledOf(engine);
+        if (result.first.empty()) ++m.unreachable;
+        else m.checksum += static_cast<unsigned long long>(result.second);
+    }
+}
+
+static measurement runEngine(const string& name, const Graph& G, const vector<query>& queries, unsigned threads) {
+    measurement m;
+    m.engine = name;
+    auto settledOf = [](const auto& engine) { return static_cast<unsigned long long>(engine.settledCount()); };
+    auto start = benchClock::now();
+
+    if (name == "dijkstra") {
+        Dijkstra<vertex> dk(G);
+        m.buildSeconds = secondsSince(start);
+        runQueries(m, dk, queries, settledOf);
+    }
+    else if (name == "csr4") {
+        csrGraph csr(G);
+        Dijkstra<csrVertex, fourAryHeap> dk(csr);
+        m.buildSeconds = secondsSince(start);
+        runQueries(m, dk, queries, settledOf);
+    }
+    else if (name == "simd") {
+        csrGraph csr(G);
+        SimdDijkstra dk(csr);
+        m.buildSeconds = secondsSince(start);
+        runQueries(m, dk, queries, settledOf);
+    }
+    else if (name == "rcm" || name == "degree" || name == "partition") {
+        const auto perm = name == "rcm" ? cuthillMcKeeOrder(G) : name == "degree" ? degreeOrder(G) : partitionOrder(G);
+        const Graph reordered = reorderGraph(G, perm);
+        m.reorderSeconds = secondsSince(start);
+        csrGraph csr(reordered);
+        Reordered<Dijkstra<csrVertex, fourAryHeap>> dk(perm, csr);
+        m.buildSeconds = secondsSince(start);
+        runQueries(m, dk, queries, settledOf);
+    }
+    else if (name == "compact") {
+        compactGraph compact(G);
+        Dijkstra<compactVertex, fourAryHeap> dk(compact);
+        m.buildSeconds = secondsSince(start);
+        runQueries(m, dk, queries, settledOf);
+    }
+    else if (name == "auto") {
+        csrGraph csr(G);
+        Dijkstra<csrVertex, autoQueue> dk(csr);
+        m.buildSeconds = secondsSince(start);
+        runQueries(m, dk, queries, settledOf);
+    }
+    else if (name == "bidir") {
+        BiDijkstra<vertex> dk(G);
+        m.buildSeconds = secondsSince(start);
+        runQueries(m, dk, queries, settledOf);
+    }
+    else if (name == "alt") {
+        landmarks lm(G, 16);
+        AStar<vertex, altHeuristic> dk(G, altHeuristic(lm));
+        m.buildSeconds = secondsSince(start);
+        runQueries(m, dk, queries, settledOf);
+    }
+    else if (name == "ch") {
+        contractionHierarchy ch;
+        ch.build(G, threads);
+        CHDijkstra dk(ch);
+        m.buildSeconds = secondsSince(start);
+        runQueries(m, dk, queries, settledOf);
+    }
+    else if (name == "delta") {
+        DeltaStepping<vertex> dk(G, threads);
+        m.buildSeconds = secondsSince(start);
+        m.hasSettled = false;
+        runQueries(m, dk, queries, [](const DeltaStepping<vertex>&) { return 0ull; });
+    }
+    else
+        throw invalid_argument("Unknown engine: " + name);
+    return m;
+}
+
+//  Перцентиль по ближайшему рангу (latencies отсортирован)
+static double percentile(const vector<double>& latencies, double p) {
+    if (latencies.empty()) return 0;
+    size_t rank = static_cast<size_t>(p / 100.0 * latencies.size() + 0.5);
+    return latencies[min(latencies.size() - 1, rank == 0 ? 0 : rank - 1)];
+}
+
+static vector<string> splitList(const string& list) {
+    vector<string> result;
+    stringstream in(list);
+    string item;
+    while (getline(in, item, ','))
+        if (!item.empty()) result.push_back(item);
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    string families = "random,grid,road,rmat";
+    string sizes = "1e4,1e5";
+    string engines = "dijkstra,csr4,auto,bidir,alt";
+    string format = "text";
+    size_t queryCount = 1000;
+    unsigned threads = 0;
+    unsigned long long seed = 1;
+
+    for (int i = 1; i < argc; i += 2) {
+        string key = argv[i];
+        if (i + 1 == argc) {
+            cerr << "Option " << key << " needs a value\n";
+            return 2;
+        }
+        string value = argv[i + 1];
+        if (key == "--families") families = value;
+        else if (key == "--edges") sizes = value;
+        else if (key == "--engines") engines = value;
+        else if (key == "--format") format = value;
+        else if (key == "--queries") queryCount = stoull(value);
+        else if (key == "--threads") threads = static_cast<unsigned>(stoul(value));
+        else if (key == "--seed") seed = stoull(value);
+        else {
+            cerr << "Unknown option " << key << "\n";
+            return 2;
+        }
+    }
+    const bool json = format == "json";
+    bool mismatch = false;
+
+    if (!json)
+        cout << "family\tvertices\tedges\tengine\tbuild_s\tp50_us\tp90_us\tp99_us\tmax_us\tsettled_per_s\treorder_s\tpeak_rss_kb\tchecksum\n";
+
+    for (const string& family : splitList(families))
+        for (const string& size : splitList(sizes)) {
+            Graph::sizetype edges = static_cast<Graph::sizetype>(stod(size));
+            auto start = benchClock::now();
+            const Graph G = generateFamily(family, edges, seed);
+            double generateSeconds = secondsSince(start);
+            size_t edgeCount = 0;
+            for (const vertex& v : G.vertices)
+                edgeCount += v.adj.size();
+
+            //  Запросы - от своего генератора, чтобы не зависеть от того, сколько чисел съел генератор графа
+            std::mt19937_64 rng(seed ^ 0x9e3779b97f4a7c15ull);
+            vector<query> queries;
+            for (size_t i = 0; i < queryCount; ++i) {
+                vertex::size_type from = static_cast<vertex::size_type>(uniformIndex(rng, G.size()));
+                vertex::size_type to = static_cast<vertex::size_type>(uniformIndex(rng, G.size()));
+                queries.push_back(make_pair(from, to));
+            }
+
+            //  Все движки точные - ответы первого из них служат образцом для остальных
+            string referenceEngine;
+            unsigned long long referenceChecksum = 0;
+            size_t referenceUnreachable = 0;
+            for (const string& engine : splitList(engines)) {
+                measurement m = runEngine(engine, G, queries, threads);
+                if (referenceEngine.empty()) {
+                    referenceEngine = m.engine;
+                    referenceChecksum = m.checksum;
+                    referenceUnreachable = m.unreachable;
+                }
+                else if (m.checksum != referenceChecksum || m.unreachable != referenceUnreachable) {
+                    cerr << "Checksum mismatch on " << family << " " << G.size() << ": " << m.engine << " "
+                        << m.checksum << " (" << m.unreachable << " unreachable), " << referenceEngine << " "
+                        << referenceChecksum << " (" << referenceUnreachable << " unreachable)\n";
+                    mismatch = true;
+                }
+                vector<double> sorted(m.latencies);
+                sort(sorted.begin(), sorted.end());
+                double total = 0;
+                for (double x : sorted) total += x;
+                double settledPerSecond = total > 0 ? m.settled / (total * 1e-6) : 0;
+
+                if (json) {
+                    cout << "{\"family\":\"" << family << "\",\"seed\":" << seed
+                        << ",\"vertices\":" << G.size() << ",\"edges\":" << edgeCount
+                        << ",\"generate_s\":" << generateSeconds
+                        << ",\"engine\":\"" << m.engine << "\",\"build_s\":" << m.buildSeconds
+                        << ",\"queries\":" << sorted.size() << ",\"unreachable\":" << m.unreachable
+                        << ",\"mean_us\":" << (sorted.empty() ? 0 : total / sorted.size())
+                        << ",\"p50_us\":" << percentile(sorted, 50) << ",\"p90_us\":" << percentile(sorted, 90)
+                        << ",\"p99_us\":" << percentile(sorted, 99) << ",\"max_us\":" << (sorted.empty() ? 0 : sorted.back())
+                        << ",\"settled\":" << m.settled << ",\"settled_per_s\":";
+                    if (m.hasSettled) cout << settledPerSecond;
+                    else cout << "null";
+                    cout << ",\"reorder_s\":";
+                    if (m.reorderSeconds >= 0) cout << m.reorderSeconds;
+                    else cout << "null";
+                    cout << ",\"peak_rss_kb\":" << peakRssKB() << ",\"checksum\":" << m.checksum << "}" << endl;
+                }
+                else {
+                    cout << family << '\t' << G.size() << '\t' << edgeCount << '\t' << m.engine << '\t'
+                        << m.buildSeconds << '\t' << percentile(sorted, 50) << '\t' << percentile(sorted, 90) << '\t'
+                        << percentile(sorted, 99) << '\t' << (sorted.empty() ? 0 : sorted.back()) << '\t';
+                    if (m.hasSettled) cout << settledPerSecond;
+                    else cout << '-';
+                    cout << '\t';
+                    if (m.reorderSeconds >= 0) cout << m.reorderSeconds;
+                    else cout << '-';
+                    cout << '\t' << peakRssKB() << '\t' << m.checksum << endl;
+                }
+            }
+        }
+
+    return mismatch ? 1 : 0;
+}
@@ -0,0 +1,187 @@
+//---------------------------------------------------------------------------------------------------------
+//  Двунаправленный алгоритм Дейкстры для запросов "из точки в точку".
+//
+//  Поиск идёт одновременно от стартовой вершины по прямым рёбрам и от финишной - по обратным
+//  (обращённый граф строится один раз в конструкторе в виде csrGraph). На каждом шаге продвигается
+//  тот фронт, у которого минимальная оценка в очереди меньше. Как только сумма минимальных оценок
+//  обеих очередей становится не меньше длины лучшего найденного пути через "точку встречи",
+//  поиск заканчивается - лучший путь уже не улучшить.
+//
+//  Требования к графу те же, что и в Dijkstra.h. Результат - такая же пара (путь, стоимость),
+//  как у Dijkstra::calcPath.
+//---------------------------------------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+#include "Dijkstra.h"
+#include "CSRGraph.h"
+
+template<typename vertexType>
+class BiDijkstra {
+private:
+
+	//  Типы для индексов и весов
+	using size_type = typename graphVertex<vertexType>::size_type;
+	using weight_type = typename graphVertex<vertexType>::weight_type;
+
+	using forwardNode = graphVertex<vertexType>;
+	using backwardNode = graphVertex<csrVertex>;
+
+	template<typename nodeType>
+	using queueType = ExtPriority_Queue<nodeType, std::vector<queueElem<nodeType>>, std::greater<queueElem<nodeType>>>;
+
+	//  Обращённый граф - по нему идёт поиск от финиша
+	csrGraph reverse;
+
+	//  Обёртки вершин для прямого и обратного поиска
+	std::vector<forwardNode> forward;
+	std::vector<backwardNode> backward;
+
+	queueType<forwardNode> forwardQueue;
+	queueType<backwardNode> backwardQueue;
+
+	//  Затронутые прошлым запросом вершины (как в Dijkstra, сбрасываем только их)
+	std::vector<size_type> forwardTouched;
+	std::vector<size_type> backwardTouched;
+
+	//  Количество закрытых вершин в последнем запросе (суммарно по обоим направлениям)
+	size_type settled = 0;
+
+	template<typename nodeType>
+	static void resetNodes(std::vector<nodeType>& nodes, std::vector<size_type>& touched) noexcept {
+		for (size_type index : touched) {
+			nodes[index].parent = std::numeric_limits<size_type>::max();
+			nodes[index].weight = std::numeric_limits<weight_type>::max();
+			nodes[index].state = vertexState::None;
+			nodes[index].index = std::numeric_limits<size_type>::max();
+		}
+		touched.clear();
+	}
+
+	void reset() noexcept {
+		resetNodes(forward, forwardTouched);
+		resetNodes(backward, backwardTouched);
+		forwardQueue.clear();
+		backwardQueue.clear();
+		settled = 0;
+	}
+
+	//  Один шаг одного из фронтов: закрываем вершину с минимальной оценкой и релаксируем её рёбра.
+	//  Если сосед уже достигнут встречным поиском, то пробуем улучшить рекорд best через него
+	template<typename nodeType, typename otherNodeType>
+	void step(std::vector<nodeType>& nodes, const std::vector<otherNodeType>& other,
+		queueType<nodeType>& epq, std::vector<size_type>& touched, weight_type& best, size_type& meet) {
+
+		//  top возвращает ссылку на саму обёртку вершины, так что после pop она остаётся живой
+		const nodeType& current(epq.top());
+		epq.pop();
+
+		size_type currentIndex = current.vertex->name;
+		nodes[currentIndex].state = vertexState::Finished;
+		++settled;
+
+		for (auto adjIt = current.vertex->cbegin(); adjIt != current.vertex->cend(); ++adjIt) {
+			size_type dest = adjIt->dest;
+			weight_type candidate = current.weight + adjIt->weight;
+
+			if (nodes[dest].state == vertexState::None) {
+				nodes[dest].state = vertexState::Opened;
+				nodes[dest].parent = currentIndex;
+				nodes[dest].weight = candidate;
+				touched.push_back(dest);
+				epq.push(nodes[dest]);
+			}
+			else if (nodes[dest].state != vertexState::Finished && nodes[dest].weight > candidate) {
+				nodes[dest].weight = candidate;
+				nodes[dest].parent = currentIndex;
+				epq.decreaseKey(nodes[dest].index);
+			}
+
+			//  Встречный поиск уже добрался до соседа - есть путь через ребро (current, dest)
+			if (other[dest].state != vertexState::None && candidate + other[dest].weight < best) {
+				best = candidate + other[dest].weight;
+				meet = dest;
+			}
+		}
+	}
+
+public:
+	//  Конструктор - цепляется к существующему графу и строит обращённый граф
+	template<typename vertexCont>
+	explicit BiDijkstra(const vertexCont& cont) : reverse(csrGraph::transposed(cont)) {
+		for (auto it = cont.cbegin(); it != cont.cend(); ++it)
+			forward.push_back(forwardNode(*it));
+		for (auto it = reverse.cbegin(); it != reverse.cend(); ++it)
+			backward.push_back(backwardNode(*it));
+	}
+
+	//  Обёртки указывают на вершины собственного обращённого графа - копировать нельзя
+	BiDijkstra(const BiDijkstra&) = delete;
+	BiDijkstra& operator=(const BiDijkstra&) = delete;
+
+	//  Количество закрытых вершин в последнем запросе
+	size_type settledCount() const noexcept { return settled; }
+
+	//  Двунаправленный поиск - ищем последовательность индексов вершин, и стоимость пути
+	std::pair<std::vector<size_type>, weight_type> calcPath(size_type startIndex, size_type finishIndex) {
+		if (startIndex >= forward.size() || finishIndex >= forward.size())
+			throw std::out_of_range("Wrong start or finish node index!");
+
+		reset();
+
+		if (startIndex == finishIndex)
+			return make_pair(std::vector<size_type>(1, startIndex), weight_type(0));
+
+		forward[startIndex].parent = startIndex;
+		forward[startIndex].weight = 0;
+		forward[startIndex].state = vertexState::Opened;
+		forwardTouched.push_back(startIndex);
+		forwardQueue.push(forward[startIndex]);
+
+		backward[finishIndex].parent = finishIndex;
+		backward[finishIndex].weight = 0;
+		backward[finishIndex].state = vertexState::Opened;
+		backwardTouched.push_back(finishIndex);
+		backwardQueue.push(backward[finishIndex]);
+
+		//  Длина лучшего найденного пути и вершина, в которой встретились фронты
+		weight_type best = std::numeric_limits<weight_type>::max();
+		size_type meet = std::numeric_limits<size_type>::max();
+
+		//  Если один из фронтов исчерпан, то все пути через него уже учтены в best
+		while (!forwardQueue.empty() && !backwardQueue.empty()) {
+			weight_type forwardMin = forwardQueue.top().weight;
+			weight_type backwardMin = backwardQueue.top().weight;
+			if (forwardMin + backwardMin >= best) break;
+
+			if (forwardMin <= backwardMin)
+				step(forward, backward, forwardQueue, forwardTouched, best, meet);
+			else
+				step(backward, forward, backwardQueue, backwardTouched, best, meet);
+		}
+
+		//  Пути не существует
+		if (meet == std::numeric_limits<size_type>::max())
+			return make_pair(std::vector<size_type>(), weight_type(0));
+
+		//  Путь собирается из двух половинок: от старта до точки встречи по прямым родителям,
+		//  и от точки встречи до финиша - по родителям обратного поиска
+		std::vector<size_type> path;
+		size_type nodeIndex(meet);
+		path.push_back(nodeIndex);
+		while (nodeIndex != startIndex) {
+			nodeIndex = forward[nodeIndex].parent;
+			path.push_back(nodeIndex);
+		}
+		std::reverse(path.begin(), path.end());
+		nodeIndex = meet;
+		while (nodeIndex != finishIndex) {
+			nodeIndex = backward[nodeIndex].parent;
+			path.push_back(nodeIndex);
+		}
+		return make_pair(path, best);
+	}
+};
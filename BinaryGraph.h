@@ -0,0 +1,302 @@
+//---------------------------------------------------------------------------------------------------------
+//  Двоичный формат графа и его загрузка через отображение файла в память (mmap).
+//
+//  Текстовый формат Graph::saveToFile приходится разбирать по одному числу, и при больших графах
+//  загрузка занимает больше времени, чем все запросы. Двоичный файл устроен так же, как csrGraph:
+//
+//    [заголовок, 64 байта]
+//    [offsets - (V+1) индексов]  [dests - E индексов]  [weights - E весов]
+//
+//  Каждый массив начинается с границы 64 байт. В заголовке записаны версия формата, отметка порядка
+//  байт и ширина индексов и весов. Файл отображается в память как есть, и mappedGraph смотрит прямо
+//  в отображённые массивы - ничего не копируется и не разбирается, стоимость загрузки определяется
+//  подкачкой страниц. В памяти создаются только лёгкие "ручки" вершин (как у csrGraph), без которых
+//  Dijkstra не может запомнить адреса вершин.
+//
+//  Формат проверяется строго: если порядок байт или ширина типов не совпадают с текущей сборкой,
+//  файл отвергается - без копирования данные всё равно не прочитать. Заголовку тоже не верим:
+//  массивы должны быть выровнены и целиком лежать в файле, смещения - не убывать и закончиться
+//  количеством рёбер, номера вершин в рёбрах - быть меньше количества вершин. Ради этого offsets
+//  и dests при загрузке один раз просматриваются, зато испорченный файл не приведёт к чтению
+//  за пределами отображения во время поиска.
+//---------------------------------------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include "CSRGraph.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+//  Заголовок двоичного файла графа
+struct binaryGraphHeader {
+	char signature[4];
+	std::uint32_t version;
+	//  Записывается как 0x01020304 - при другом порядке байт прочитается иначе
+	std::uint32_t endianness;
+	std::uint8_t indexWidth;
+	std::uint8_t weightWidth;
+	std::uint16_t reserved;
+	std::uint64_t vertexCount;
+	std::uint64_t edgeCount;
+	//  Смещения массивов от начала файла
+	std::uint64_t offsetsPos;
+	std::uint64_t destsPos;
+	std::uint64_t weightsPos;
+
+	static constexpr std::uint32_t currentVersion = 1;
+	static constexpr std::uint32_t endiannessMark = 0x01020304;
+	static constexpr std::uint64_t alignment = 64;
+
+	static std::uint64_t align(std::uint64_t pos) noexcept { return (pos + alignment - 1) / alignment * alignment; }
+};
+
+static_assert(sizeof(binaryGraphHeader) <= binaryGraphHeader::alignment, "Binary graph header must fit into one block");
+
+//  Запись любого графа, удовлетворяющего требованиям из Dijkstra.h, в двоичный формат.
+//  Рёбра пишутся потоком, без построения CSR в памяти (граф обходится дважды)
+template<typename vertexCont>
+void saveBinaryGraph(const vertexCont& cont, std::string filename) {
+	using size_type = csrView::size_type;
+	using weight_type = csrView::weight_type;
+
+	std::ofstream out(filename, std::ios_base::out | std::ios_base::binary);
+	if (!out)
+		throw std::runtime_error("Can't create graph file " + filename);
+
+	//  Степени вершин - сразу в виде смещений. Рёбра пишутся в порядке обхода,
+	//  поэтому вершины должны идти по порядку имён
+	std::vector<size_type> offsets(1, 0);
+	for (auto it = cont.cbegin(); it != cont.cend(); ++it) {
+		if (it->name != offsets.size() - 1)
+			throw std::invalid_argument("Vertices must be ordered by name to write binary graph");
+		size_type degree = 0;
+		for (auto adjIt = it->cbegin(); adjIt != it->cend(); ++adjIt)
+			++degree;
+		offsets.push_back(offsets.back() + degree);
+	}
+
+	binaryGraphHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.signature, "DJKG", 4);
+	header.version = binaryGraphHeader::currentVersion;
+	header.endianness = binaryGraphHeader::endiannessMark;
+	header.indexWidth = sizeof(size_type);
+	header.weightWidth = sizeof(weight_type);
+	header.vertexCount = offsets.size() - 1;
+	header.edgeCount = offsets.back();
+	header.offsetsPos = binaryGraphHeader::alignment;
+	header.destsPos = binaryGraphHeader::align(header.offsetsPos + offsets.size() * sizeof(size_type));
+	header.weightsPos = binaryGraphHeader::align(header.destsPos + header.edgeCount * sizeof(size_type));
+
+	auto padTo = [&out](std::uint64_t pos) {
+		static const char zeros[binaryGraphHeader::alignment] = {};
+		std::uint64_t current = static_cast<std::uint64_t>(out.tellp());
+		out.write(zeros, static_cast<std::streamsize>(pos - current));
+	};
+
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	padTo(header.offsetsPos);
+	out.write(reinterpret_cast<const char*>(offsets.data()), static_cast<std::streamsize>(offsets.size() * sizeof(size_type)));
+
+	//  Буфер, чтобы не писать в поток по одному числу
+	std::vector<size_type> destBuffer;
+	std::vector<weight_type> weightBuffer;
+	const size_t bufferSize = 1 << 16;
+
+	padTo(header.destsPos);
+	for (auto it = cont.cbegin(); it != cont.cend(); ++it)
+		for (auto adjIt = it->cbegin(); adjIt != it->cend(); ++adjIt) {
+			destBuffer.push_back(adjIt->dest);
+			if (destBuffer.size() == bufferSize) {
+				out.write(reinterpret_cast<const char*>(destBuffer.data()), static_cast<std::streamsize>(destBuffer.size() * sizeof(size_type)));
+				destBuffer.clear();
+			}
+		}
+	out.write(reinterpret_cast<const char*>(destBuffer.data()), static_cast<std::streamsize>(destBuffer.size() * sizeof(size_type)));
+
+	padTo(header.weightsPos);
+	for (auto it = cont.cbegin(); it != cont.cend(); ++it)
+		for (auto adjIt = it->cbegin(); adjIt != it->cend(); ++adjIt) {
+			weightBuffer.push_back(adjIt->weight);
+			if (weightBuffer.size() == bufferSize) {
+				out.write(reinterpret_cast<const char*>(weightBuffer.data()), static_cast<std::streamsize>(weightBuffer.size() * sizeof(weight_type)));
+				weightBuffer.clear();
+			}
+		}
+	out.write(reinterpret_cast<const char*>(weightBuffer.data()), static_cast<std::streamsize>(weightBuffer.size() * sizeof(weight_type)));
+
+	if (!out)
+		throw std::runtime_error("Can't write graph file " + filename);
+	out.close();
+}
+
+//  Граф только для чтения поверх отображённого в память двоичного файла.
+//  Удовлетворяет требованиям из Dijkstra.h: Dijkstra<csrVertex> работает с ним так же, как с csrGraph
+class mappedGraph {
+public:
+	using size_type = csrView::size_type;
+	using weight_type = csrView::weight_type;
+	using vertex_type = csrVertex;
+
+	explicit mappedGraph(std::string filename) {
+		map(filename);
+		try {
+			bind(filename);
+		}
+		catch (...) {
+			unmap();
+			throw;
+		}
+	}
+
+	~mappedGraph() { unmap(); }
+
+	//  Вершины ссылаются на представление внутри объекта, а объект владеет отображением
+	mappedGraph(const mappedGraph&) = delete;
+	mappedGraph& operator=(const mappedGraph&) = delete;
+
+	size_type size() const noexcept { return view.vertexCount; }
+	size_type edgeCount() const noexcept { return view.edgeCount; }
+
+	std::vector<csrVertex>::const_iterator cbegin() const { return vertices.cbegin(); }
+	std::vector<csrVertex>::const_iterator cend() const { return vertices.cend(); }
+
+	const csrVertex& operator[](size_type index) const { return vertices[index]; }
+
+	const csrView& arrays() const noexcept { return view; }
+
+	//  Подсказка системе заранее подкачать весь файл (например, перед серией запросов)
+	void prefetch() const noexcept {
+#if defined(_WIN32)
+		WIN32_MEMORY_RANGE_ENTRY range{ const_cast<void*>(data), static_cast<SIZE_T>(length) };
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+		madvise(const_cast<void*>(data), length, MADV_WILLNEED);
+#endif
+	}
+
+private:
+	const void* data = nullptr;
+	size_t length = 0;
+#if defined(_WIN32)
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+#endif
+
+	csrView view;
+	std::vector<csrVertex> vertices;
+
+	void map(const std::string& filename) {
+#if defined(_WIN32)
+		file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			throw std::runtime_error("Can't open graph file " + filename);
+		LARGE_INTEGER fileSize;
+		GetFileSizeEx(file, &fileSize);
+		length = static_cast<size_t>(fileSize.QuadPart);
+		mapping = length ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+		data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (!data) {
+			unmap();
+			throw std::runtime_error("Can't map graph file " + filename);
+		}
+#else
+		int fd = open(filename.c_str(), O_RDONLY);
+		if (fd < 0)
+			throw std::runtime_error("Can't open graph file " + filename);
+		struct stat info;
+		if (fstat(fd, &info) != 0 || info.st_size == 0) {
+			close(fd);
+			throw std::runtime_error("Can't map graph file " + filename);
+		}
+		length = static_cast<size_t>(info.st_size);
+		void* address = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+		close(fd);
+		if (address == MAP_FAILED)
+			throw std::runtime_error("Can't map graph file " + filename);
+		data = address;
+#endif
+	}
+
+	void unmap() noexcept {
+#if defined(_WIN32)
+		if (data) UnmapViewOfFile(data);
+		if (mapping) CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+		mapping = nullptr;
+		file = INVALID_HANDLE_VALUE;
+#else
+		if (data) munmap(const_cast<void*>(data), length);
+#endif
+		data = nullptr;
+		length = 0;
+	}
+
+	//  Массив из count элементов по width байт с позиции pos выровнен и целиком лежит в файле
+	bool fits(std::uint64_t pos, std::uint64_t count, std::uint64_t width) const noexcept {
+		return pos % binaryGraphHeader::alignment == 0 && pos >= sizeof(binaryGraphHeader) && pos <= length
+			&& count <= (length - pos) / width;
+	}
+
+	//  Проверка заголовка и привязка представления к массивам внутри файла
+	void bind(const std::string& filename) {
+		if (length < sizeof(binaryGraphHeader))
+			throw std::runtime_error("Graph file is too short: " + filename);
+		const char* base = static_cast<const char*>(data);
+		binaryGraphHeader header;
+		std::memcpy(&header, base, sizeof(header));
+
+		if (std::memcmp(header.signature, "DJKG", 4) != 0)
+			throw std::runtime_error("Wrong graph file format: " + filename);
+		if (header.version != binaryGraphHeader::currentVersion)
+			throw std::runtime_error("Unsupported graph file version: " + filename);
+		if (header.endianness != binaryGraphHeader::endiannessMark)
+			throw std::runtime_error("Graph file has different byte order: " + filename);
+		if (header.indexWidth != sizeof(size_type) || header.weightWidth != sizeof(weight_type))
+			throw std::runtime_error("Graph file has different index or weight width: " + filename);
+
+		//  Количества сравниваются делением, а не умножением, чтобы огромные значения из заголовка
+		//  не переполнили размер массива
+		if (header.vertexCount >= std::numeric_limits<size_type>::max() || header.edgeCount > std::numeric_limits<size_type>::max())
+			throw std::runtime_error("Graph file is corrupted: " + filename);
+		if (!fits(header.offsetsPos, header.vertexCount + 1, sizeof(size_type))
+			|| !fits(header.destsPos, header.edgeCount, sizeof(size_type))
+			|| !fits(header.weightsPos, header.edgeCount, sizeof(weight_type)))
+			throw std::runtime_error("Graph file is truncated or misaligned: " + filename);
+
+		view.offsets = reinterpret_cast<const size_type*>(base + header.offsetsPos);
+		view.dests = reinterpret_cast<const size_type*>(base + header.destsPos);
+		view.weights = reinterpret_cast<const weight_type*>(base + header.weightsPos);
+		view.vertexCount = static_cast<size_type>(header.vertexCount);
+		view.edgeCount = static_cast<size_type>(header.edgeCount);
+
+		if (view.offsets[0] != 0 || view.offsets[view.vertexCount] != view.edgeCount)
+			throw std::runtime_error("Graph file is corrupted: " + filename);
+		for (size_type i = 0; i < view.vertexCount; ++i)
+			if (view.offsets[i] > view.offsets[i + 1])
+				throw std::runtime_error("Graph file is corrupted: " + filename);
+		for (size_type i = 0; i < view.edgeCount; ++i)
+			if (view.dests[i] >= view.vertexCount)
+				throw std::runtime_error("Graph file is corrupted: " + filename);
+
+		vertices.reserve(view.vertexCount);
+		for (size_type i = 0; i < view.vertexCount; ++i)
+			vertices.push_back(csrVertex(view, i));
+	}
+};
@@ -0,0 +1,295 @@
+//---------------------------------------------------------------------------------------------------------
+//  Компактное неизменяемое представление графа в формате CSR (Compressed Sparse Row).
+//
+//  Вместо отдельного вектора рёбер в каждой вершине храним три непрерывных массива:
+//    - offsets (V+1 элемент) - рёбра вершины i лежат в диапазоне [offsets[i], offsets[i+1]);
+//    - dests   (E элементов) - куда ведут рёбра;
+//    - weights (E элементов) - веса рёбер.
+//  Обход смежных вершин превращается в последовательное чтение двух массивов, а не в прыжок
+//  по отдельной куче-аллокации на каждую вершину.
+//
+//  Граф удовлетворяет требованиям из Dijkstra.h, так что Dijkstra<csrVertex> работает с ним
+//  без изменений. Для этого хранится ещё массив лёгких "ручек" вершин (имя + указатель на массивы),
+//  ведь Dijkstra запоминает адреса вершин.
+//---------------------------------------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <algorithm>
+#include "Graph.h"
+
+//  Невладеющее представление CSR-массивов - его разделяют вершины графа
+struct csrView {
+	using size_type = edge::size_type;
+	using weight_type = edge::weight_type;
+
+	const size_type* offsets = nullptr;
+	const size_type* dests = nullptr;
+	const weight_type* weights = nullptr;
+	size_type vertexCount = 0;
+	size_type edgeCount = 0;
+};
+
+//  Итератор по рёбрам вершины - идёт параллельно по массивам dests и weights.
+//  Разыменование даёт ребро по значению, так что adjIt->dest и adjIt->weight работают как для vertex
+class csrEdgeIterator {
+public:
+	using size_type = csrView::size_type;
+	using weight_type = csrView::weight_type;
+
+	using iterator_category = std::forward_iterator_tag;
+	using value_type = edge;
+	using difference_type = std::ptrdiff_t;
+	using reference = edge;
+
+	//  Ребро живёт внутри "указателя", пока вычисляется выражение с ->
+	struct pointer {
+		edge value;
+		const edge* operator->() const noexcept { return &value; }
+	};
+
+	csrEdgeIterator() = default;
+	csrEdgeIterator(const size_type* Dest, const weight_type* Weight) noexcept : dest(Dest), weight(Weight) {}
+
+	inline edge operator*() const noexcept { return edge(*dest, *weight); }
+	inline pointer operator->() const noexcept { return pointer{ edge(*dest, *weight) }; }
+
+	inline csrEdgeIterator& operator++() noexcept { ++dest; ++weight; return *this; }
+	inline csrEdgeIterator operator++(int) noexcept { csrEdgeIterator tmp(*this); ++(*this); return tmp; }
+
+	inline bool operator==(const csrEdgeIterator& other) const noexcept { return dest == other.dest; }
+	inline bool operator!=(const csrEdgeIterator& other) const noexcept { return dest != other.dest; }
+
+private:
+	const size_type* dest = nullptr;
+	const weight_type* weight = nullptr;
+};
+
+//  Вершина CSR-графа - только имя и ссылка на общие массивы
+class csrVertex {
+public:
+	using size_type = csrView::size_type;
+	using weight_type = csrView::weight_type;
+	using const_iterator = csrEdgeIterator;
+
+	//  Имя - это просто номер/индекс
+	size_type name;
+
+	csrVertex(const csrView& View, size_type Name) noexcept : name(Name), view(&View) {}
+
+	//  Константные итераторы на списки смежных рёбер
+	const_iterator cbegin() const noexcept {
+		size_type first = view->offsets[name];
+		return const_iterator(view->dests + first, view->weights + first);
+	}
+	const_iterator cend() const noexcept {
+		size_type last = view->offsets[name + 1];
+		return const_iterator(view->dests + last, view->weights + last);
+	}
+
+	size_type degree() const noexcept { return view->offsets[name + 1] - view->offsets[name]; }
+
+private:
+	friend class csrGraph;
+	const csrView* view;
+};
+
+//  Сам CSR-граф. После построения не меняется
+class csrGraph {
+public:
+	using size_type = csrView::size_type;
+	using weight_type = csrView::weight_type;
+	using vertex_type = csrVertex;
+
+	csrGraph() { bind(); }
+
+	//  Построение по любому графу, удовлетворяющему требованиям из Dijkstra.h (например, Graph)
+	template<typename vertexCont>
+	explicit csrGraph(const vertexCont& cont) {
+		build(cont, false);
+	}
+
+	//  Граф с обращёнными рёбрами - понадобится для поиска "от финиша"
+	template<typename vertexCont>
+	static csrGraph transposed(const vertexCont& cont) {
+		csrGraph result;
+		result.build(cont, true);
+		return result;
+	}
+
+	csrGraph(const csrGraph& other) : offsets(other.offsets), dests(other.dests), weights(other.weights) { bind(); }
+	csrGraph(csrGraph&& other) noexcept :
+		offsets(std::move(other.offsets)), dests(std::move(other.dests)), weights(std::move(other.weights)),
+		vertices(std::move(other.vertices)) {
+		bind();
+		other.bind();
+	}
+	csrGraph& operator=(const csrGraph& other) {
+		if (this != &other) {
+			offsets = other.offsets;
+			dests = other.dests;
+			weights = other.weights;
+			bind();
+		}
+		return *this;
+	}
+	csrGraph& operator=(csrGraph&& other) noexcept {
+		if (this != &other) {
+			offsets = std::move(other.offsets);
+			dests = std::move(other.dests);
+			weights = std::move(other.weights);
+			vertices = std::move(other.vertices);
+			bind();
+			other.bind();
+		}
+		return *this;
+	}
+
+	size_type size() const noexcept { return view.vertexCount; }
+	size_type edgeCount() const noexcept { return view.edgeCount; }
+
+	std::vector<csrVertex>::const_iterator cbegin() const { return vertices.cbegin(); }
+	std::vector<csrVertex>::const_iterator cend() const { return vertices.cend(); }
+
+	const csrVertex& operator[](size_type index) const { return vertices[index]; }
+
+	//  Прямой доступ к массивам - для кода, которому итераторы не нужны
+	const csrView& arrays() const noexcept { return view; }
+
+	//  Текстовый формат тот же, что у Graph::saveToFile
+	void saveToFile(std::string filename) const {
+		std::ofstream out(filename, std::ios_base::out);
+		out << size() << '\n';
+		for (size_type i = 0; i < size(); ++i)
+			if (offsets[i + 1] > offsets[i]) {
+				out << i << ' ' << offsets[i + 1] - offsets[i] << '\n';
+				for (size_type e = offsets[i]; e < offsets[i + 1]; ++e)
+					out << dests[e] << ' ' << weights[e] << '\n';
+			}
+		out.close();
+	}
+
+	//  Загрузка из текстового файла сразу в CSR, без промежуточных векторов для каждой вершины.
+	//  Рёбра складываются в порядке файла; если блоки вершин идут не по порядку (или повторяются),
+	//  то в конце выполняется сортировка подсчётом
+	void loadFromFile(std::string filename) {
+		std::ifstream in(filename, std::ios_base::in);
+		if (!in)
+			throw std::runtime_error("Can't open graph file " + filename);
+
+		size_type Size = 0;
+		in >> Size;
+
+		offsets.assign(Size + 1, 0);
+		dests.clear();
+		weights.clear();
+
+		//  Блоки файла: чья вершина, с какого ребра начинается, сколько рёбер
+		struct block { size_type vert, first, count; };
+		std::vector<block> blocks;
+		bool ordered = true;
+
+		size_type vert, N;
+		while (in >> vert >> N) {
+			if (vert >= Size)
+				throw std::out_of_range("Wrong vertex index in graph file!");
+			if (!blocks.empty() && blocks.back().vert >= vert)
+				ordered = false;
+			blocks.push_back({ vert, static_cast<size_type>(dests.size()), N });
+			for (size_type i = 0; i < N; ++i) {
+				size_type dest;
+				weight_type w;
+				if (!(in >> dest >> w))
+					throw std::runtime_error("Unexpected end of graph file!");
+				//  Ребро в несуществующую вершину иначе всплыло бы выходом за границы уже в поиске
+				if (dest >= Size)
+					throw std::out_of_range("Wrong edge destination in graph file!");
+				dests.push_back(dest);
+				weights.push_back(w);
+			}
+			offsets[vert + 1] += N;
+		}
+		in.close();
+
+		for (size_type i = 0; i < Size; ++i)
+			offsets[i + 1] += offsets[i];
+
+		if (!ordered) {
+			std::vector<size_type> pos(offsets.begin(), offsets.end() - 1);
+			std::vector<size_type> sortedDests(dests.size());
+			std::vector<weight_type> sortedWeights(weights.size());
+			for (const block& b : blocks)
+				for (size_type i = 0; i < b.count; ++i) {
+					sortedDests[pos[b.vert]] = dests[b.first + i];
+					sortedWeights[pos[b.vert]] = weights[b.first + i];
+					++pos[b.vert];
+				}
+			dests.swap(sortedDests);
+			weights.swap(sortedWeights);
+		}
+		dests.shrink_to_fit();
+		weights.shrink_to_fit();
+		bind();
+	}
+
+private:
+	std::vector<size_type> offsets;
+	std::vector<size_type> dests;
+	std::vector<weight_type> weights;
+
+	csrView view;
+	std::vector<csrVertex> vertices;
+
+	//  Перепривязываем представление и вершины к собственным массивам (после построения, копирования, перемещения)
+	void bind() {
+		if (offsets.empty())
+			offsets.push_back(0);
+		view.offsets = offsets.data();
+		view.dests = dests.data();
+		view.weights = weights.data();
+		view.vertexCount = offsets.size() - 1;
+		view.edgeCount = dests.size();
+
+		if (vertices.size() != view.vertexCount) {
+			vertices.clear();
+			vertices.reserve(view.vertexCount);
+			for (size_type i = 0; i < view.vertexCount; ++i)
+				vertices.push_back(csrVertex(view, i));
+		}
+		else
+			for (csrVertex& v : vertices)
+				v.view = &view;
+	}
+
+	//  Два прохода: сначала считаем степени, затем раскладываем рёбра по местам
+	template<typename vertexCont>
+	void build(const vertexCont& cont, bool reversed) {
+		size_type Size = 0;
+		for (auto it = cont.cbegin(); it != cont.cend(); ++it)
+			++Size;
+
+		offsets.assign(Size + 1, 0);
+		for (auto it = cont.cbegin(); it != cont.cend(); ++it)
+			for (auto adjIt = it->cbegin(); adjIt != it->cend(); ++adjIt)
+				++offsets[(reversed ? adjIt->dest : it->name) + 1];
+		for (size_type i = 0; i < Size; ++i)
+			offsets[i + 1] += offsets[i];
+
+		dests.resize(offsets[Size]);
+		weights.resize(offsets[Size]);
+		std::vector<size_type> pos(offsets.begin(), offsets.end() - 1);
+		for (auto it = cont.cbegin(); it != cont.cend(); ++it)
+			for (auto adjIt = it->cbegin(); adjIt != it->cend(); ++adjIt) {
+				size_type from = reversed ? adjIt->dest : it->name;
+				size_type to = reversed ? it->name : adjIt->dest;
+				dests[pos[from]] = to;
+				weights[pos[from]] = adjIt->weight;
+				++pos[from];
+			}
+		bind();
+	}
+};
@@ -0,0 +1,754 @@
+//---------------------------------------------------------------------------------------------------------
+//  Контрактные иерархии (Contraction Hierarchies) для статических графов.
+//
+//  Предобработка: вершины по очереди "стягиваются" в порядке важности. При стягивании вершины v
+//  для каждой пары соседей u -> v -> w проверяется, есть ли путь u ~> w в обход v не длиннее,
+//  чем u -> v -> w (поиск "свидетеля"). Если нет - добавляется ребро-сокращение u -> w с пометкой
+//  средней вершины v. Важность вершины - удвоенная разность рёбер (сколько сокращений добавится минус
+//  сколько рёбер исчезнет) плюс количество уже стянутых соседей.
+//
+//  Стягивание идёт раундами: в каждом раунде выбирается независимое множество вершин, важность
+//  которых меньше, чем у всех их соседей, и поиски свидетелей для них выполняются параллельно.
+//  Соседи вершин множества не входят в него, поэтому сокращения одной вершины не затрагивают другие;
+//  вершины множества в поисках свидетелей не участвуют.
+//
+//  Важность пересчитывается лениво: после стягивания у соседей она только помечается устаревшей,
+//  а пересчитывается (симуляцией стягивания) лишь тогда, когда вершина по старой оценке оказалась
+//  кандидатом - минимумом среди соседей. Так на плотных графах, где множества маленькие и раундов
+//  много, дорогая симуляция не повторяется для всех соседей в каждом раунде.
+//
+//  После предобработки у каждой вершины остаются рёбра "вверх" (к вершинам, стянутым позже) и
+//  входящие рёбра "сверху". Запрос - двунаправленный алгоритм Дейкстры, который ходит только вверх:
+//  от старта по исходящим рёбрам вверх, от финиша - по входящим рёбрам сверху. Сокращения в
+//  найденном пути рекурсивно раскрываются, так что результат - тот же полный путь, что у calcPath.
+//
+//  Метод рассчитан на разреженные графы вроде дорожных сетей. На плотных случайных графах
+//  (как у Graph::generateGraph) сокращений становится слишком много, и предобработка не окупается.
+//---------------------------------------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <string>
+#include <fstream>
+#include <limits>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+#include "Dijkstra.h"
+#include "CSRGraph.h"
+
+//  Метка вершины для поисков по иерархии - то же, что graphVertex, но без ссылки на вершину графа:
+//  рёбра берутся из самой иерархии по номеру вершины
+struct chVertex {
+	using size_type = csrGraph::size_type;
+	using weight_type = csrGraph::weight_type;
+
+	size_type name;
+	size_type parent;
+	weight_type weight;
+	vertexState state;
+	size_t index;
+
+	explicit chVertex(size_type Name) noexcept :
+		name(Name),
+		parent(std::numeric_limits<size_type>::max()),
+		weight(std::numeric_limits<weight_type>::max()),
+		state(vertexState::None),
+		index(std::numeric_limits<size_t>::max())
+	{}
+
+	inline void update_index(size_t new_index) { index = new_index; }
+
+	inline void reset() noexcept {
+		parent = std::numeric_limits<size_type>::max();
+		weight = std::numeric_limits<weight_type>::max();
+		state = vertexState::None;
+		index = std::numeric_limits<size_t>::max();
+	}
+
+	inline bool operator<(const chVertex& other) const { return weight < other.weight; }
+	inline bool operator>(const chVertex& other) const { return weight > other.weight; }
+};
+
+class contractionHierarchy {
+public:
+	using size_type = csrGraph::size_type;
+	using weight_type = csrGraph::weight_type;
+
+	//  Отметка "ребро исходное, а не сокращение"
+	static constexpr size_type noMiddle = std::numeric_limits<size_type>::max();
+
+	//  Предел закрытых вершин в одном поиске свидетеля. Если свидетель не найден за это время,
+	//  сокращение добавляется "на всякий случай" - это не ломает корректность, лишь добавляет рёбер.
+	//  При оценке важности вершины достаточно более грубого поиска
+	static constexpr size_type witnessLimit = 500;
+	static constexpr size_type simulationLimit = 50;
+
+	contractionHierarchy() = default;
+
+	//  Предобработка графа, удовлетворяющего требованиям из Dijkstra.h. threads == 0 - по числу ядер
+	template<typename vertexCont>
+	explicit contractionHierarchy(const vertexCont& cont, unsigned threads = 0) {
+		build(cont, threads);
+	}
+
+	template<typename vertexCont>
+	void build(const vertexCont& cont, unsigned threads = 0);
+
+	size_type size() const noexcept { return rank.size(); }
+	size_type shortcutCount() const noexcept { return shortcuts; }
+
+	//  Порядковый номер стягивания вершины - чем больше, тем вершина "важнее"
+	size_type level(size_type v) const noexcept { return rank[v]; }
+
+	//  Рёбра вверх из v: v -> w, где w стянута позже v
+	const edge* upBegin(size_type v) const noexcept { return upEdges.data() + upOffsets[v]; }
+	const edge* upEnd(size_type v) const noexcept { return upEdges.data() + upOffsets[v + 1]; }
+
+	//  Входящие рёбра сверху в v: u -> v, где u стянута позже v. В поле dest хранится u
+	const edge* downBegin(size_type v) const noexcept { return downEdges.data() + downOffsets[v]; }
+	const edge* downEnd(size_type v) const noexcept { return downEdges.data() + downOffsets[v + 1]; }
+
+	//  Раскрытие ребра from -> to иерархии в последовательность вершин исходного графа.
+	//  В path дописываются все вершины после from, включая to
+	void unpack(size_type from, size_type to, std::vector<size_type>& path) const;
+
+	void saveToFile(std::string filename) const;
+	void loadFromFile(std::string filename);
+
+private:
+	static constexpr char signature[4] = { 'C', 'H', '0', '1' };
+
+	std::vector<size_type> rank;
+	size_type shortcuts = 0;
+
+	std::vector<size_type> upOffsets;
+	std::vector<edge> upEdges;
+	std::vector<size_type> upMiddle;
+
+	std::vector<size_type> downOffsets;
+	std::vector<edge> downEdges;
+	std::vector<size_type> downMiddle;
+
+	//  Ребро рабочего графа во время стягивания
+	struct arc {
+		size_type other;
+		weight_type weight;
+		size_type middle;
+	};
+
+	//  Сокращение, найденное при стягивании вершины middle
+	struct shortcut {
+		size_type from, to;
+		weight_type weight;
+	};
+
+	//  Поиск свидетелей - ограниченный алгоритм Дейкстры по рабочему графу. У каждого потока свой
+	class witnessSearch {
+	public:
+		explicit witnessSearch(size_type Size) : isTarget(Size, 0) {
+			nodes.reserve(Size);
+			for (size_type i = 0; i < Size; ++i)
+				nodes.push_back(chVertex(i));
+		}
+
+		//  Расстояния от source, не проходя через excluded и вершины с пометкой skip.
+		//  Поиск останавливается, когда закрыты все цели, или по достижении limitWeight,
+		//  или после settleLimit закрытых вершин
+		void run(const std::vector<std::vector<arc>>& out, size_type source, size_type excluded,
+			const std::vector<char>& skip, weight_type limitWeight, size_type settleLimit) {
+			for (size_type index : touched)
+				nodes[index].reset();
+			touched.clear();
+			epq.clear();
+
+			nodes[source].weight = 0;
+			nodes[source].state = vertexState::Opened;
+			touched.push_back(source);
+			epq.push(nodes[source]);
+
+			size_type settled = 0, targetsLeft = targets;
+			while (!epq.empty() && settled < settleLimit && targetsLeft > 0) {
+				chVertex& current = nodes[epq.top().name];
+				epq.pop();
+				if (current.weight > limitWeight) break;
+				current.state = vertexState::Finished;
+				++settled;
+				if (isTarget[current.name]) --targetsLeft;
+
+				for (const arc& a : out[current.name]) {
+					if (a.other == excluded || skip[a.other]) continue;
+					chVertex& next = nodes[a.other];
+					weight_type candidate = current.weight + a.weight;
+					if (next.state == vertexState::None) {
+						next.state = vertexState::Opened;
+						next.weight = candidate;
+						touched.push_back(a.other);
+						epq.push(next);
+					}
+					else if (next.state != vertexState::Finished && next.weight > candidate) {
+						next.weight = candidate;
+						epq.decreaseKey(next.index);
+					}
+				}
+			}
+		}
+
+		inline weight_type distance(size_type v) const noexcept { return nodes[v].weight; }
+
+		//  Цели поиска - вершины, до которых нужны расстояния
+		inline void addTarget(size_type v) noexcept { isTarget[v] = 1; ++targets; }
+		inline void clearTargets(const std::vector<arc>& list) noexcept {
+			for (const arc& a : list)
+				isTarget[a.other] = 0;
+			targets = 0;
+		}
+
+	private:
+		std::vector<chVertex> nodes;
+		std::vector<char> isTarget;
+		size_type targets = 0;
+		std::vector<size_type> touched;
+		ExtPriority_Queue<chVertex, std::vector<queueElem<chVertex>>, std::greater<queueElem<chVertex>>> epq;
+	};
+
+	//  Какие сокращения понадобятся при стягивании v
+	static void findShortcuts(const std::vector<std::vector<arc>>& out, const std::vector<std::vector<arc>>& in,
+		size_type v, const std::vector<char>& skip, size_type settleLimit, witnessSearch& search, std::vector<shortcut>& result) {
+		result.clear();
+		if (out[v].empty()) return;
+		weight_type maxOut = 0;
+		for (const arc& a : out[v]) {
+			maxOut = std::max(maxOut, a.weight);
+			search.addTarget(a.other);
+		}
+
+		for (const arc& incoming : in[v]) {
+			size_type u = incoming.other;
+			search.run(out, u, v, skip, incoming.weight + maxOut, settleLimit);
+			for (const arc& outgoing : out[v]) {
+				size_type w = outgoing.other;
+				if (w == u) continue;
+				weight_type viaV = incoming.weight + outgoing.weight;
+				if (search.distance(w) > viaV)
+					result.push_back({ u, w, viaV });
+			}
+		}
+		search.clearTargets(out[v]);
+	}
+
+	//  Добавление рёбер [first, last) в список одной вершины рабочего графа - из параллельных рёбер
+	//  оставляем самое короткое. slot[other] - место соседа в списке: отметки ставятся на время вызова
+	//  и снимаются в конце, так что кратное ребро находится за O(1), а не проходом по списку
+	template<typename arcIter>
+	static void addArcs(std::vector<arc>& list, arcIter first, arcIter last, std::vector<size_type>& slot) {
+		for (size_type i = 0; i < list.size(); ++i)
+			slot[list[i].other] = i;
+		for (; first != last; ++first) {
+			const arc& a = *first;
+			size_type& place = slot[a.other];
+			if (place == noMiddle) {
+				place = list.size();
+				list.push_back(a);
+			}
+			else if (a.weight < list[place].weight)
+				list[place] = a;
+		}
+		for (const arc& a : list)
+			slot[a.other] = noMiddle;
+	}
+
+	static void removeArc(std::vector<arc>& list, size_type other) {
+		list.erase(std::remove_if(list.begin(), list.end(), [other](const arc& a) { return a.other == other; }), list.end());
+	}
+
+	//  Поиск ребра from -> to в списке вершины owner (самого короткого, если их несколько)
+	static size_type findEdge(const std::vector<size_type>& offsets, const std::vector<edge>& edges,
+		size_type owner, size_type other) {
+		size_type best = noMiddle;
+		for (size_type e = offsets[owner]; e < offsets[owner + 1]; ++e)
+			if (edges[e].dest == other && (best == noMiddle || edges[e].weight < edges[best].weight))
+				best = e;
+		if (best == noMiddle)
+			throw std::logic_error("Broken contraction hierarchy: missing edge");
+		return best;
+	}
+
+	//  Запуск функции для индексов [0, count) на нескольких потоках
+	template<typename Func>
+	static void parallelFor(size_type count, unsigned threads, Func func) {
+		std::atomic<size_type> next(0);
+		auto worker = [&](unsigned thread) {
+			for (size_type i = next++; i < count; i = next++)
+				func(thread, i);
+		};
+		std::vector<std::thread> pool;
+		for (unsigned t = 1; t < threads; ++t)
+			pool.emplace_back(worker, t);
+		worker(0);
+		for (std::thread& th : pool)
+			th.join();
+	}
+
+	static void writeValue(std::ofstream& out, std::uint64_t value) {
+		out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+	static std::uint64_t readValue(std::ifstream& in) {
+		std::uint64_t value = 0;
+		in.read(reinterpret_cast<char*>(&value), sizeof(value));
+		return value;
+	}
+};
+
+template<typename vertexCont>
+void contractionHierarchy::build(const vertexCont& cont, unsigned threads) {
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+
+	size_type Size = 0;
+	for (auto it = cont.cbegin(); it != cont.cend(); ++it)
+		++Size;
+
+	//  Места соседей в списке для addArcs; вне вызова все отметки пусты
+	std::vector<size_type> slot(Size, noMiddle);
+	std::vector<arc> batch;
+
+	//  Рабочий граф: исходящие и входящие рёбра ещё не стянутых вершин, без петель и кратных рёбер.
+	//  Кратные рёбра убираются в исходящих списках, входящие строятся уже по ним
+	std::vector<std::vector<arc>> out(Size), in(Size);
+	for (auto it = cont.cbegin(); it != cont.cend(); ++it) {
+		batch.clear();
+		for (auto adjIt = it->cbegin(); adjIt != it->cend(); ++adjIt)
+			if (adjIt->dest != it->name)
+				batch.push_back({ adjIt->dest, adjIt->weight, noMiddle });
+		addArcs(out[it->name], batch.begin(), batch.end(), slot);
+	}
+	for (size_type v = 0; v < Size; ++v)
+		for (const arc& a : out[v])
+			in[a.other].push_back({ v, a.weight, noMiddle });
+
+	//  Рёбра вверх/сверху каждой вершины, зафиксированные в момент её стягивания
+	std::vector<std::vector<arc>> up(Size), down(Size);
+
+	rank.assign(Size, noMiddle);
+	shortcuts = 0;
+
+	std::vector<std::ptrdiff_t> priority(Size, 0);
+	std::vector<size_type> contractedNeighbours(Size, 0);
+	std::vector<char> dirty(Size, 1);
+	std::vector<char> inSet(Size, 0);
+	std::vector<char> noSkip(Size, 0);
+
+	std::vector<witnessSearch> searches;
+	for (unsigned t = 0; t < threads; ++t)
+		searches.emplace_back(Size);
+	std::vector<std::vector<shortcut>> scratch(threads);
+
+	std::vector<size_type> remaining(Size);
+	for (size_type v = 0; v < Size; ++v)
+		remaining[v] = v;
+
+	//  Пересчёт важности вершин из списка, у которых она устарела
+	auto updatePriorities = [&](const std::vector<size_type>& list) {
+		parallelFor(list.size(), threads, [&](unsigned thread, size_type i) {
+			size_type v = list[i];
+			findShortcuts(out, in, v, noSkip, simulationLimit, searches[thread], scratch[thread]);
+			std::ptrdiff_t edgeDifference = std::ptrdiff_t(scratch[thread].size()) - std::ptrdiff_t(out[v].size() + in[v].size());
+			priority[v] = 2 * edgeDifference + std::ptrdiff_t(contractedNeighbours[v]);
+			dirty[v] = 0;
+		});
+	};
+
+	//  Вершина менее важна, чем все её соседи (при равенстве сравниваем номера)
+	auto less = [&](size_type a, size_type b) {
+		return priority[a] < priority[b] || (priority[a] == priority[b] && a < b);
+	};
+	auto localMinimum = [&](size_type v) {
+		for (const arc& a : out[v])
+			if (!less(v, a.other)) return false;
+		for (const arc& a : in[v])
+			if (!less(v, a.other)) return false;
+		return true;
+	};
+
+	std::vector<size_type> candidates, stale, independent;
+	std::vector<std::vector<shortcut>> found;
+	size_type nextRank = 0;
+
+	updatePriorities(remaining);
+
+	while (!remaining.empty()) {
+		//  Кандидаты - минимумы среди соседей по текущим, возможно устаревшим, оценкам. Устаревшие
+		//  оценки кандидатов пересчитываем, и в множество идут те, кто остался минимумом. Две соседние
+		//  вершины минимумами одновременно быть не могут, так что множество независимое
+		candidates.clear();
+		stale.clear();
+		for (size_type v : remaining)
+			if (localMinimum(v)) {
+				candidates.push_back(v);
+				if (dirty[v]) stale.push_back(v);
+			}
+		updatePriorities(stale);
+
+		independent.clear();
+		for (size_type v : candidates)
+			if (localMinimum(v)) {
+				independent.push_back(v);
+				inSet[v] = 1;
+			}
+		//  Пересчёт мог поднять оценки всех кандидатов - тогда в следующем раунде кандидаты будут другие
+		if (independent.empty())
+			continue;
+
+		//  Сокращения для всех вершин множества - параллельно, в обход всего множества
+		found.resize(independent.size());
+		parallelFor(independent.size(), threads, [&](unsigned thread, size_type i) {
+			findShortcuts(out, in, independent[i], inSet, witnessLimit, searches[thread], found[i]);
+		});
+
+		//  Применяем стягивание - последовательно
+		for (size_type i = 0; i < independent.size(); ++i) {
+			size_type v = independent[i];
+			rank[v] = nextRank++;
+			up[v] = out[v];
+			down[v] = in[v];
+
+			for (const arc& a : out[v]) {
+				removeArc(in[a.other], v);
+				++contractedNeighbours[a.other];
+				dirty[a.other] = 1;
+			}
+			for (const arc& a : in[v]) {
+				removeArc(out[a.other], v);
+				++contractedNeighbours[a.other];
+				dirty[a.other] = 1;
+			}
+
+			//  Сокращения группируем по начальной вершине, потом по конечной, и добавляем группами
+			std::vector<shortcut>& list = found[i];
+			auto addGroups = [&](std::vector<std::vector<arc>>& lists, bool byFrom) {
+				std::sort(list.begin(), list.end(), [byFrom](const shortcut& a, const shortcut& b) {
+					return byFrom ? a.from < b.from : a.to < b.to;
+				});
+				for (size_type first = 0; first < list.size();) {
+					const size_type owner = byFrom ? list[first].from : list[first].to;
+					batch.clear();
+					for (; first < list.size() && (byFrom ? list[first].from : list[first].to) == owner; ++first)
+						batch.push_back({ byFrom ? list[first].to : list[first].from, list[first].weight, v });
+					addArcs(lists[owner], batch.begin(), batch.end(), slot);
+				}
+			};
+			addGroups(out, true);
+			addGroups(in, false);
+			shortcuts += list.size();
+
+			std::vector<arc>().swap(out[v]);
+			std::vector<arc>().swap(in[v]);
+			inSet[v] = 0;
+		}
+
+		remaining.erase(std::remove_if(remaining.begin(), remaining.end(),
+			[this](size_type v) { return rank[v] != noMiddle; }), remaining.end());
+	}
+
+	//  Раскладываем рёбра вверх/сверху в CSR
+	auto flatten = [Size](std::vector<std::vector<arc>>& lists, std::vector<size_type>& offsets,
+		std::vector<edge>& edges, std::vector<size_type>& middle) {
+		offsets.assign(Size + 1, 0);
+		for (size_type v = 0; v < Size; ++v)
+			offsets[v + 1] = offsets[v] + lists[v].size();
+		edges.clear();
+		edges.reserve(offsets[Size]);
+		middle.clear();
+		middle.reserve(offsets[Size]);
+		for (size_type v = 0; v < Size; ++v) {
+			for (const arc& a : lists[v]) {
+				edges.push_back(edge(a.other, a.weight));
+				middle.push_back(a.middle);
+			}
+			std::vector<arc>().swap(lists[v]);
+		}
+	};
+	flatten(up, upOffsets, upEdges, upMiddle);
+	flatten(down, downOffsets, downEdges, downMiddle);
+}
+
+inline void contractionHierarchy::unpack(size_type from, size_type to, std::vector<size_type>& path) const {
+	//  Стек рёбер для раскрытия: (откуда, куда). Рекурсия заменена стеком, чтобы не зависеть от глубины
+	std::vector<std::pair<size_type, size_type>> stack;
+	stack.push_back(std::make_pair(from, to));
+
+	while (!stack.empty()) {
+		std::pair<size_type, size_type> current = stack.back();
+		stack.pop_back();
+		size_type u = current.first, w = current.second;
+
+		//  Ребро хранится у того конца, который стянут раньше: у u в списке "вверх" или у w в списке "сверху"
+		size_type middle;
+		if (rank[u] < rank[w])
+			middle = upMiddle[findEdge(upOffsets, upEdges, u, w)];
+		else
+			middle = downMiddle[findEdge(downOffsets, downEdges, w, u)];
+
+		if (middle == noMiddle)
+			path.push_back(w);
+		else {
+			//  Сначала раскрываем u -> middle, потом middle -> w
+			stack.push_back(std::make_pair(middle, w));
+			stack.push_back(std::make_pair(u, middle));
+		}
+	}
+}
+
+inline void contractionHierarchy::saveToFile(std::string filename) const {
+	std::ofstream out(filename, std::ios_base::out | std::ios_base::binary);
+	if (!out)
+		throw std::runtime_error("Can't create hierarchy file " + filename);
+	out.write(signature, sizeof(signature));
+	writeValue(out, rank.size());
+	writeValue(out, shortcuts);
+	for (size_type r : rank)
+		writeValue(out, r);
+	auto writeGraph = [&out](const std::vector<size_type>& offsets, const std::vector<edge>& edges,
+		const std::vector<size_type>& middle) {
+		writeValue(out, edges.size());
+		for (size_type o : offsets)
+			writeValue(out, o);
+		for (size_type e = 0; e < edges.size(); ++e) {
+			writeValue(out, edges[e].dest);
+			writeValue(out, edges[e].weight);
+			writeValue(out, middle[e] == noMiddle ? std::numeric_limits<std::uint64_t>::max() : middle[e]);
+		}
+	};
+	writeGraph(upOffsets, upEdges, upMiddle);
+	writeGraph(downOffsets, downEdges, downMiddle);
+	out.close();
+}
+
+inline void contractionHierarchy::loadFromFile(std::string filename) {
+	std::ifstream in(filename, std::ios_base::in | std::ios_base::binary);
+	if (!in)
+		throw std::runtime_error("Can't open hierarchy file " + filename);
+	char header[sizeof(signature)];
+	in.read(header, sizeof(header));
+	if (!in || !std::equal(header, header + sizeof(header), signature))
+		throw std::runtime_error("Wrong hierarchy file format: " + filename);
+
+	//  Размеры из заголовка сверяем с длиной файла до выделения памяти: каждое значение занимает 8 байт
+	const std::streamoff start = in.tellg();
+	in.seekg(0, std::ios_base::end);
+	const std::uint64_t values = static_cast<std::uint64_t>(in.tellg() - start) / sizeof(std::uint64_t);
+	in.seekg(start);
+	auto corrupt = [&filename]() { return std::runtime_error("Hierarchy file is corrupted: " + filename); };
+
+	const std::uint64_t storedSize = readValue(in);
+	shortcuts = static_cast<size_type>(readValue(in));
+	//  Ранги, и для двух графов - количество рёбер и Size + 1 смещений
+	if (values < 6 || storedSize > (values - 6) / 3 || static_cast<size_type>(storedSize) != storedSize)
+		throw corrupt();
+	const size_type Size = static_cast<size_type>(storedSize);
+	std::uint64_t left = values - 6 - 3 * storedSize;
+
+	//  Ранги должны быть перестановкой - на их порядке держатся и поиск, и раскрытие путей
+	rank.resize(Size);
+	std::vector<bool> used(Size, false);
+	for (size_type& r : rank) {
+		r = static_cast<size_type>(readValue(in));
+		if (r >= Size || used[r])
+			throw corrupt();
+		used[r] = true;
+	}
+
+	//  Рёбра обоих графов ведут к вершине с большим рангом, середина укороченного ребра - ниже его
+	//  начала; тогда раскрытие пути заканчивается, а поиск не выходит за массивы
+	auto readGraph = [&](std::vector<size_type>& offsets, std::vector<edge>& edges, std::vector<size_type>& middle) {
+		const std::uint64_t count = readValue(in);
+		if (count > left / 3)
+			throw corrupt();
+		left -= 3 * count;
+		offsets.resize(Size + 1);
+		for (size_type& o : offsets)
+			o = static_cast<size_type>(readValue(in));
+		if (offsets[0] != 0 || offsets[Size] != count)
+			throw corrupt();
+		for (size_type v = 0; v < Size; ++v)
+			if (offsets[v] > offsets[v + 1])
+				throw corrupt();
+		edges.clear();
+		edges.reserve(static_cast<size_type>(count));
+		middle.resize(static_cast<size_type>(count));
+		size_type owner = 0;
+		for (size_type e = 0; e < count; ++e) {
+			while (offsets[owner + 1] <= e)
+				++owner;
+			size_type dest = static_cast<size_type>(readValue(in));
+			weight_type weight = static_cast<weight_type>(readValue(in));
+			std::uint64_t mid = readValue(in);
+			if (dest >= Size || rank[dest] <= rank[owner])
+				throw corrupt();
+			if (mid != std::numeric_limits<std::uint64_t>::max() && (mid >= Size || rank[mid] >= rank[owner]))
+				throw corrupt();
+			edges.push_back(edge(dest, weight));
+			middle[e] = mid == std::numeric_limits<std::uint64_t>::max() ? noMiddle : static_cast<size_type>(mid);
+		}
+	};
+	readGraph(upOffsets, upEdges, upMiddle);
+	readGraph(downOffsets, downEdges, downMiddle);
+	if (!in)
+		throw std::runtime_error("Hierarchy file is truncated: " + filename);
+}
+
+//---------------------------------------------------------------------------------------------------------
+//  Запросы по иерархии. Объект хранит только метки вершин и очереди, так что на одну иерархию
+//  можно завести по объекту на поток
+class CHDijkstra {
+private:
+	using size_type = contractionHierarchy::size_type;
+	using weight_type = contractionHierarchy::weight_type;
+	using queueType = ExtPriority_Queue<chVertex, std::vector<queueElem<chVertex>>, std::greater<queueElem<chVertex>>>;
+
+	const contractionHierarchy* hierarchy;
+
+	std::vector<chVertex> forward;
+	std::vector<chVertex> backward;
+	queueType forwardQueue;
+	queueType backwardQueue;
+	std::vector<size_type> forwardTouched;
+	std::vector<size_type> backwardTouched;
+
+	size_type settled = 0;
+
+	static void resetNodes(std::vector<chVertex>& nodes, std::vector<size_type>& touched) noexcept {
+		for (size_type index : touched)
+			nodes[index].reset();
+		touched.clear();
+	}
+
+	//  Шаг поиска вверх: рёбра берутся из [begin, end) иерархии
+	template<typename edgesFunc>
+	void step(std::vector<chVertex>& nodes, const std::vector<chVertex>& other, queueType& epq,
+		std::vector<size_type>& touched, edgesFunc edges, weight_type& best, size_type& meet) {
+		const chVertex& current(epq.top());
+		epq.pop();
+
+		size_type currentIndex = current.name;
+		nodes[currentIndex].state = vertexState::Finished;
+		++settled;
+
+		//  Встреча в самой вершине
+		if (other[currentIndex].state != vertexState::None && current.weight + other[currentIndex].weight < best) {
+			best = current.weight + other[currentIndex].weight;
+			meet = currentIndex;
+		}
+
+		const edge* begin = edges.first(currentIndex);
+		const edge* end = edges.second(currentIndex);
+		for (const edge* e = begin; e != end; ++e) {
+			chVertex& next = nodes[e->dest];
+			weight_type candidate = current.weight + e->weight;
+			if (next.state == vertexState::None) {
+				next.state = vertexState::Opened;
+				next.parent = currentIndex;
+				next.weight = candidate;
+				touched.push_back(e->dest);
+				epq.push(next);
+			}
+			else if (next.state != vertexState::Finished && next.weight > candidate) {
+				next.weight = candidate;
+				next.parent = currentIndex;
+				epq.decreaseKey(next.index);
+			}
+			if (other[e->dest].state != vertexState::None && candidate + other[e->dest].weight < best) {
+				best = candidate + other[e->dest].weight;
+				meet = e->dest;
+			}
+		}
+	}
+
+public:
+	explicit CHDijkstra(const contractionHierarchy& ch) : hierarchy(&ch) {
+		forward.reserve(ch.size());
+		backward.reserve(ch.size());
+		for (size_type i = 0; i < ch.size(); ++i) {
+			forward.push_back(chVertex(i));
+			backward.push_back(chVertex(i));
+		}
+	}
+
+	size_type settledCount() const noexcept { return settled; }
+
+	//  Поиск пути - результат такой же, как у Dijkstra::calcPath (сокращения раскрыты)
+	std::pair<std::vector<size_type>, weight_type> calcPath(size_type startIndex, size_type finishIndex) {
+		if (startIndex >= forward.size() || finishIndex >= forward.size())
+			throw std::out_of_range("Wrong start or finish node index!");
+
+		resetNodes(forward, forwardTouched);
+		resetNodes(backward, backwardTouched);
+		forwardQueue.clear();
+		backwardQueue.clear();
+		settled = 0;
+
+		forward[startIndex].parent = startIndex;
+		forward[startIndex].weight = 0;
+		forward[startIndex].state = vertexState::Opened;
+		forwardTouched.push_back(startIndex);
+		forwardQueue.push(forward[startIndex]);
+
+		backward[finishIndex].parent = finishIndex;
+		backward[finishIndex].weight = 0;
+		backward[finishIndex].state = vertexState::Opened;
+		backwardTouched.push_back(finishIndex);
+		backwardQueue.push(backward[finishIndex]);
+
+		weight_type best = std::numeric_limits<weight_type>::max();
+		size_type meet = std::numeric_limits<size_type>::max();
+
+		const contractionHierarchy& ch = *hierarchy;
+		auto upEdges = std::make_pair(
+			[&ch](size_type v) { return ch.upBegin(v); },
+			[&ch](size_type v) { return ch.upEnd(v); });
+		auto downEdges = std::make_pair(
+			[&ch](size_type v) { return ch.downBegin(v); },
+			[&ch](size_type v) { return ch.downEnd(v); });
+
+		//  В отличие от обычного двунаправленного поиска, остановиться при встрече фронтов нельзя -
+		//  каждое направление идёт, пока его минимальная оценка меньше рекорда
+		while (true) {
+			bool forwardActive = !forwardQueue.empty() && forwardQueue.top().weight < best;
+			bool backwardActive = !backwardQueue.empty() && backwardQueue.top().weight < best;
+			if (!forwardActive && !backwardActive) break;
+
+			if (forwardActive && (!backwardActive || forwardQueue.top().weight <= backwardQueue.top().weight))
+				step(forward, backward, forwardQueue, forwardTouched, upEdges, best, meet);
+			else
+				step(backward, forward, backwardQueue, backwardTouched, downEdges, best, meet);
+		}
+
+		if (meet == std::numeric_limits<size_type>::max())
+			return make_pair(std::vector<size_type>(), weight_type(0));
+
+		//  Цепочка вершин иерархии от старта до точки встречи и от неё до финиша
+		std::vector<size_type> chain;
+		size_type nodeIndex(meet);
+		chain.push_back(nodeIndex);
+		while (nodeIndex != startIndex) {
+			nodeIndex = forward[nodeIndex].parent;
+			chain.push_back(nodeIndex);
+		}
+		std::reverse(chain.begin(), chain.end());
+		nodeIndex = meet;
+		while (nodeIndex != finishIndex) {
+			nodeIndex = backward[nodeIndex].parent;
+			chain.push_back(nodeIndex);
+		}
+
+		//  Раскрываем сокращения
+		std::vector<size_type> path;
+		path.push_back(startIndex);
+		for (size_type i = 0; i + 1 < chain.size(); ++i)
+			ch.unpack(chain[i], chain[i + 1], path);
+		return make_pair(path, best);
+	}
+};
@@ -0,0 +1,194 @@
+//---------------------------------------------------------------------------------------------------------
+//  d-арная индексированная куча - стратегия очереди для Dijkstra.
+//
+//  В отличие от ExtPriority_Queue, в массиве кучи хранятся не указатели на обёртки вершин, а сами пары
+//  (ключ, номер вершины). Сравнения при просеивании не ходят по разбросанному вектору nodes, а все D
+//  потомков узла лежат в массиве подряд. Массив выделяется с выравниванием по кэш-линии (64 байта),
+//  а перед корнем стоят D-1 пустых элемента: тогда потомки узла i (D*i+1 ... D*i+D) начинаются
+//  с элемента D*(i+1) массива, и при D = 4 и 16-байтовых элементах занимают ровно одну кэш-линию.
+//  Место каждой вершины в куче хранится в отдельном массиве pos, его нужно обновлять только для
+//  перемещённых элементов. Высота кучи при этом в log2(D) раз меньше, чем у двоичной.
+//
+//  Использование:  Dijkstra<vertex, fourAryHeap> dk(G);
+//---------------------------------------------------------------------------------------------------------
+
+#pragma once
+#include <new>
+#include <vector>
+#include <limits>
+#include <cstddef>
+#include <utility>
+#include "SearchStats.h"
+
+//  Распределитель для std::vector с выравниванием по кэш-линии
+template<typename T>
+struct cacheAlignedAllocator {
+	using value_type = T;
+	static constexpr std::size_t alignment = 64;
+
+	cacheAlignedAllocator() noexcept = default;
+	template<typename U>
+	cacheAlignedAllocator(const cacheAlignedAllocator<U>&) noexcept {}
+
+	T* allocate(std::size_t n) {
+		return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignment)));
+	}
+	void deallocate(T* p, std::size_t) noexcept {
+		::operator delete(p, std::align_val_t(alignment));
+	}
+
+	template<typename U>
+	bool operator==(const cacheAlignedAllocator<U>&) const noexcept { return true; }
+	template<typename U>
+	bool operator!=(const cacheAlignedAllocator<U>&) const noexcept { return false; }
+};
+
+template<typename nodeType, unsigned D>
+class dAryHeap {
+	static_assert(D >= 2, "Heap arity must be at least 2");
+
+	using size_type = typename nodeType::size_type;
+	using weight_type = typename nodeType::weight_type;
+
+	//  Элемент кучи - ключ и номер вершины рядом
+	struct item {
+		weight_type key;
+		size_type id;
+	};
+
+	static constexpr size_type npos = std::numeric_limits<size_type>::max();
+
+	//  Пустые элементы перед корнем - чтобы группы потомков начинались с границы кэш-линии
+	static constexpr size_type rootSlot = D - 1;
+
+	//  Элемент с номером i лежит в heap[rootSlot + i]; data - это heap.data() + rootSlot
+	std::vector<item, cacheAlignedAllocator<item>> heap;
+	item* data = nullptr;
+	size_type count = 0;
+	//  pos[id] - место вершины id в куче (npos, если её там нет)
+	std::vector<size_type> pos;
+
+	inline static size_type parent(size_type i) noexcept { return (i - 1) / D; }
+	inline static size_type firstChild(size_type i) noexcept { return D * i + 1; }
+
+	//  Поднимаем элемент к корню. Элементы не меняются местами, а сдвигаются вниз в "дырку",
+	//  сам элемент записывается один раз в конце
+	template<typename statsType>
+	void siftUp(size_type index, statsType& stats) noexcept {
+		item moving = data[index];
+		while (index > 0) {
+			size_type p = parent(index);
+			if (!(moving.key < data[p].key)) break;
+			data[index] = data[p];
+			pos[data[index].id] = index;
+			stats.countSiftStep();
+			index = p;
+		}
+		data[index] = moving;
+		pos[moving.id] = index;
+	}
+
+	//  Топим элемент - меняем с минимальным из D потомков, пока он больше него
+	template<typename statsType>
+	void siftDown(size_type index, statsType& stats) noexcept {
+		item moving = data[index];
+		const size_type size = count;
+		while (true) {
+			size_type first = firstChild(index);
+			if (first >= size) break;
+			size_type last = first + D < size ? first + D : size;
+
+			size_type best = first;
+			for (size_type c = first + 1; c < last; ++c)
+				if (data[c].key < data[best].key)
+					best = c;
+
+			if (!(data[best].key < moving.key)) break;
+			data[index] = data[best];
+			pos[data[index].id] = index;
+			stats.countSiftStep();
+			index = best;
+		}
+		data[index] = moving;
+		pos[moving.id] = index;
+	}
+
+public:
+	dAryHeap() : heap(rootSlot) { data = heap.data() + rootSlot; }
+
+	//  data указывает внутрь heap, поэтому при копировании и перемещении его нужно перевычислить
+	dAryHeap(const dAryHeap& other) : heap(other.heap), count(other.count), pos(other.pos) { data = heap.data() + rootSlot; }
+	dAryHeap(dAryHeap&& other) noexcept : heap(std::move(other.heap)), count(other.count), pos(std::move(other.pos)) {
+		data = heap.data() + rootSlot;
+		other.count = 0;
+		other.data = nullptr;
+	}
+	dAryHeap& operator=(dAryHeap other) noexcept {
+		heap.swap(other.heap);
+		pos.swap(other.pos);
+		std::swap(count, other.count);
+		data = heap.data() + rootSlot;
+		return *this;
+	}
+
+	inline void attach(std::vector<nodeType>& nodes) { pos.assign(nodes.size(), npos); }
+
+	inline void push(size_type id, weight_type key) {
+		noStats none;
+		push(id, key, none);
+	}
+
+	inline void decreaseKey(size_type id, weight_type key) noexcept {
+		noStats none;
+		decreaseKey(id, key, none);
+	}
+
+	//  Те же операции со сбором статистики просеивания (см. SearchStats.h)
+	template<typename statsType>
+	inline void push(size_type id, weight_type key, statsType& stats) {
+		heap.push_back(item{ key, id });
+		data = heap.data() + rootSlot;
+		siftUp(count++, stats);
+	}
+
+	template<typename statsType>
+	inline void decreaseKey(size_type id, weight_type key, statsType& stats) noexcept {
+		size_type index = pos[id];
+		data[index].key = key;
+		siftUp(index, stats);
+	}
+
+	inline size_type top() const { return data[0].id; }
+	inline weight_type topKey() const { return data[0].key; }
+
+	inline void pop() noexcept {
+		noStats none;
+		pop(none);
+	}
+
+	template<typename statsType>
+	inline void pop(statsType& stats) noexcept {
+		pos[data[0].id] = npos;
+		data[0] = heap.back();
+		heap.pop_back();
+		if (--count > 0)
+			siftDown(0, stats);
+	}
+
+	inline bool empty() const noexcept { return count == 0; }
+
+	//  Очистка стоит O(размер кучи), а не O(V): позиции сбрасываем только у оставшихся элементов
+	inline void clear() noexcept {
+		for (size_type i = 0; i < count; ++i)
+			pos[data[i].id] = npos;
+		heap.resize(rootSlot);
+		count = 0;
+	}
+};
+
+//  Готовые стратегии для Dijkstra: 4- и 8-арная кучи
+template<typename nodeType>
+using fourAryHeap = dAryHeap<nodeType, 4>;
+
+template<typename nodeType>
+using eightAryHeap = dAryHeap<nodeType, 8>;
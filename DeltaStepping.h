@@ -0,0 +1,376 @@
+//---------------------------------------------------------------------------------------------------------
+//  Параллельный алгоритм delta-stepping (Meyer, Sanders) для одиночных запросов "из точки в точку".
+//
+//  Dijkstra закрывает вершины строго по одной, так что один длинный запрос занимает одно ядро.
+//  Delta-stepping ослабляет порядок: вершины раскладываются по корзинам ширины delta (корзина i -
+//  расстояния [i*delta, (i+1)*delta)), и все вершины текущей корзины обрабатываются одновременно.
+//  Рёбра делятся на лёгкие (вес <= delta) и тяжёлые: релаксация лёгкого ребра может вернуть вершину
+//  в текущую корзину, поэтому лёгкие рёбра обходятся повторно, пока корзина не опустеет, а тяжёлые -
+//  один раз для всех вершин, закрытых в корзине. При delta, меньшем минимального веса, получается
+//  Dijkstra по корзинам, при бесконечном delta - Bellman-Ford.
+//
+//  Вершины распределены между потоками блоками по 64 (владелец - (v / 64) mod T). Каждая фаза идёт
+//  в два шага, разделённых барьером: сначала потоки обходят рёбра своих вершин и складывают заявки
+//  (куда, откуда, новое расстояние) в буферы владельцев, затем каждый владелец применяет заявки к своим
+//  вершинам. Так расстояния и родители меняет только владелец, и атомарные операции не нужны.
+//
+//  Корзины хранятся по кругу: при обработке корзины i новые расстояния меньше (i+1)*delta + maxWeight,
+//  так что живые корзины - не дальше ceil(maxWeight/delta) от текущей, и хватает ceil(maxWeight/delta)+1
+//  ячеек (корзина i - в ячейке i mod C). Память под корзины не растёт с длиной путей.
+//
+//  Рабочие потоки создаются один раз в конструкторе и живут, пока жив объект: между запросами они
+//  ждут следующего, а поток, вызвавший calcPath, работает как поток 0. Так на запрос не тратится
+//  создание и завершение потоков.
+//
+//  Результат - как у Dijkstra::calcPath. Поиск заканчивается, когда корзина с целевой вершиной
+//  обработана. Выгода есть на запросах, затрагивающих большую часть графа; на коротких запросах
+//  синхронизация на каждой фазе обходится дороже обычного Dijkstra.
+//
+//  Ширина корзины по умолчанию - максимальный вес ребра, делённый на среднюю степень вершины
+//  (рекомендация авторов для случайных весов); для конкретного графа её стоит подобрать.
+//---------------------------------------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <limits>
+#include <thread>
+#include <mutex>
+#include <cmath>
+#include <memory>
+#include <type_traits>
+#include <condition_variable>
+#include <stdexcept>
+#include <algorithm>
+#include "Dijkstra.h"
+
+//  Барьер для фиксированного числа потоков. Последний пришедший поток выполняет completion
+//  (пока остальные ждут), так что общие решения между фазами принимаются без гонок
+class phaseBarrier {
+	std::mutex lock;
+	std::condition_variable released;
+	unsigned count;
+	unsigned waiting = 0;
+	size_t generation = 0;
+
+public:
+	explicit phaseBarrier(unsigned Count) : count(Count) {}
+
+	template<typename completionFunc>
+	void wait(completionFunc completion) {
+		std::unique_lock<std::mutex> guard(lock);
+		size_t current = generation;
+		if (++waiting == count) {
+			completion();
+			waiting = 0;
+			++generation;
+			released.notify_all();
+		}
+		else
+			released.wait(guard, [this, current] { return generation != current; });
+	}
+
+	void wait() { wait([] {}); }
+};
+
+template<typename vertexType>
+class DeltaStepping {
+public:
+	//  weight_type - тип длин путей (см. distanceOf в Dijkstra.h)
+	using size_type = typename graphVertex<vertexType>::size_type;
+	using weight_type = typename graphVertex<vertexType>::weight_type;
+
+	//  threads == 0 - по количеству аппаратных потоков, delta == 0 - ширина корзины по умолчанию
+	template<typename vertexCont>
+	explicit DeltaStepping(const vertexCont& cont, unsigned threads = 0, weight_type delta = 0) {
+		if (threads == 0)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+
+		weight_type maxWeight = 0;
+		size_type edges = 0;
+		for (auto it = cont.cbegin(); it != cont.cend(); ++it) {
+			vertices.push_back(&*it);
+			for (auto adjIt = it->cbegin(); adjIt != it->cend(); ++adjIt) {
+				maxWeight = std::max<weight_type>(maxWeight, adjIt->weight);
+				++edges;
+			}
+		}
+
+		if (delta == 0) {
+			size_type averageDegree = vertices.empty() ? 1 : std::max<size_type>(1, edges / vertices.size());
+			delta = maxWeight / static_cast<weight_type>(averageDegree);
+			if (delta <= 0) delta = 1;
+		}
+		Delta = delta;
+
+		//  ceil(maxWeight / delta) + 1 ячеек корзин
+		if constexpr (std::is_integral<weight_type>::value)
+			slots = static_cast<size_type>((maxWeight + Delta - 1) / Delta) + 1;
+		else
+			slots = static_cast<size_type>(std::ceil(maxWeight / Delta)) + 1;
+
+		dist.assign(vertices.size(), std::numeric_limits<weight_type>::max());
+		parent.assign(vertices.size(), npos);
+		bucketOf.assign(vertices.size(), npos);
+
+		workers.resize(threads);
+		for (workerState& w : workers) {
+			w.out.resize(threads);
+			w.buckets.resize(slots);
+		}
+
+		barrier.reset(new phaseBarrier(threads));
+		for (unsigned t = 1; t < threads; ++t)
+			pool.emplace_back([this, t] { serve(t); });
+	}
+
+	//  Потоки ссылаются на объект - ни копировать, ни перемещать его нельзя
+	DeltaStepping(const DeltaStepping&) = delete;
+	DeltaStepping& operator=(const DeltaStepping&) = delete;
+
+	~DeltaStepping() {
+		{
+			std::lock_guard<std::mutex> lock(queryLock);
+			stopping = true;
+		}
+		queryReady.notify_all();
+		for (std::thread& th : pool)
+			th.join();
+	}
+
+	unsigned threads() const noexcept { return static_cast<unsigned>(workers.size()); }
+	weight_type delta() const noexcept { return Delta; }
+
+	//  Поиск пути - последовательность индексов вершин и стоимость пути
+	std::pair<std::vector<size_type>, weight_type> calcPath(size_type startIndex, size_type finishIndex) {
+		if (startIndex >= vertices.size() || finishIndex >= vertices.size())
+			throw std::out_of_range("Wrong start or finish node index!");
+
+		if (startIndex == finishIndex)
+			return make_pair(std::vector<size_type>(1, startIndex), weight_type(0));
+
+		reset();
+
+		workerState& first = workers[owner(startIndex)];
+		dist[startIndex] = 0;
+		parent[startIndex] = startIndex;
+		bucketOf[startIndex] = 0;
+		first.touched.push_back(startIndex);
+		first.buckets[0].push_back(startIndex);
+
+		finish = finishIndex;
+		current = 0;
+		again = false;
+		done = false;
+
+		//  Будим рабочие потоки, работаем сами как поток 0 и ждём, пока все выйдут из run -
+		//  до этого следующий запрос не может менять состояние поиска
+		{
+			std::lock_guard<std::mutex> lock(queryLock);
+			++queryNumber;
+			finished = 0;
+		}
+		queryReady.notify_all();
+		run(0);
+		{
+			std::unique_lock<std::mutex> lock(queryLock);
+			queryDone.wait(lock, [this] { return finished + 1 == workers.size(); });
+		}
+
+		if (dist[finishIndex] == std::numeric_limits<weight_type>::max())
+			return make_pair(std::vector<size_type>(), weight_type(0));
+
+		std::vector<size_type> path;
+		size_type nodeIndex(finishIndex);
+		path.push_back(nodeIndex);
+		while (nodeIndex != startIndex) {
+			nodeIndex = parent[nodeIndex];
+			path.push_back(nodeIndex);
+		}
+		std::reverse(path.begin(), path.end());
+		return make_pair(path, dist[finishIndex]);
+	}
+
+private:
+	static constexpr size_type npos = std::numeric_limits<size_type>::max();
+
+	//  Заявка на релаксацию: вершина dest получает расстояние weight через from
+	struct request {
+		size_type dest;
+		size_type from;
+		weight_type weight;
+	};
+
+	//  Всё, что принадлежит одному потоку: корзины его вершин, вершины, закрытые в текущей корзине
+	//  (для тяжёлых рёбер), затронутые вершины (для сброса) и исходящие заявки по владельцам
+	struct workerState {
+		std::vector<std::vector<size_type>> buckets;
+		std::vector<size_type> frontier;
+		std::vector<size_type> settled;
+		std::vector<size_type> touched;
+		std::vector<std::vector<request>> out;
+		bool nonEmpty = false;
+		size_type next = npos;
+	};
+
+	std::vector<const vertexType*> vertices;
+	weight_type Delta;
+	//  Количество ячеек кругового массива корзин
+	size_type slots = 1;
+
+	//  Расстояния, родители и номер корзины, в которой сейчас лежит вершина (npos - ни в какой)
+	std::vector<weight_type> dist;
+	std::vector<size_type> parent;
+	std::vector<size_type> bucketOf;
+
+	std::vector<workerState> workers;
+
+	//  Общее состояние фаз - меняется только в completion барьера
+	size_type finish = 0;
+	size_type current = 0;
+	bool again = false;
+	bool done = false;
+
+	//  Потоки 1..T-1: queryNumber растёт с каждым запросом, finished - сколько из них закончили текущий
+	std::unique_ptr<phaseBarrier> barrier;
+	std::vector<std::thread> pool;
+	std::mutex queryLock;
+	std::condition_variable queryReady;
+	std::condition_variable queryDone;
+	size_t queryNumber = 0;
+	size_t finished = 0;
+	bool stopping = false;
+
+	inline size_type owner(size_type v) const noexcept { return (v >> 6) % workers.size(); }
+	inline size_type bucketIndex(weight_type w) const noexcept { return static_cast<size_type>(w / Delta); }
+	inline size_type slot(size_type b) const noexcept { return b % slots; }
+
+	//  Рабочий поток: ждёт очередного запроса и участвует в нём
+	void serve(unsigned t) {
+		size_t seen = 0;
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(queryLock);
+				queryReady.wait(lock, [this, seen] { return stopping || queryNumber != seen; });
+				if (stopping) return;
+				seen = queryNumber;
+			}
+			run(t);
+			{
+				std::lock_guard<std::mutex> lock(queryLock);
+				++finished;
+			}
+			queryDone.notify_one();
+		}
+	}
+
+	void reset() noexcept {
+		for (workerState& w : workers) {
+			for (size_type v : w.touched) {
+				dist[v] = std::numeric_limits<weight_type>::max();
+				parent[v] = npos;
+				bucketOf[v] = npos;
+			}
+			w.touched.clear();
+			for (std::vector<size_type>& bucket : w.buckets)
+				bucket.clear();
+			w.settled.clear();
+			for (std::vector<request>& requests : w.out)
+				requests.clear();
+		}
+	}
+
+	//  Заявки по рёбрам вершины v - лёгким или тяжёлым. Расстояния в этой фазе никто не меняет,
+	//  поэтому заведомо бесполезные заявки отсекаются сразу
+	inline void generate(workerState& self, size_type v, bool light) {
+		weight_type base = dist[v];
+		for (auto adjIt = vertices[v]->cbegin(); adjIt != vertices[v]->cend(); ++adjIt) {
+			weight_type w = adjIt->weight;
+			if ((w <= Delta) != light) continue;
+			weight_type candidate = base + w;
+			if (candidate < dist[adjIt->dest])
+				self.out[owner(adjIt->dest)].push_back(request{ adjIt->dest, v, candidate });
+		}
+	}
+
+	//  Лёгкие рёбра вершин текущей корзины
+	void generateLight(workerState& self) {
+		self.frontier.clear();
+		self.frontier.swap(self.buckets[slot(current)]);
+		for (size_type v : self.frontier) {
+			//  Вершина уже переехала в другую корзину или встретилась повторно
+			if (bucketOf[v] != current) continue;
+			bucketOf[v] = npos;
+			self.settled.push_back(v);
+			generate(self, v, true);
+		}
+	}
+
+	//  Тяжёлые рёбра всех вершин, закрытых в текущей корзине
+	void generateHeavy(workerState& self) {
+		for (size_type v : self.settled)
+			generate(self, v, false);
+		self.settled.clear();
+	}
+
+	//  Применяем адресованные потоку заявки к его вершинам
+	void apply(unsigned t) {
+		workerState& self = workers[t];
+		for (workerState& sender : workers) {
+			for (const request& r : sender.out[t])
+				if (r.weight < dist[r.dest]) {
+					if (dist[r.dest] == std::numeric_limits<weight_type>::max())
+						self.touched.push_back(r.dest);
+					dist[r.dest] = r.weight;
+					parent[r.dest] = r.from;
+					size_type b = bucketIndex(r.weight);
+					//  Старая запись в прежней корзине станет устаревшей
+					bucketOf[r.dest] = b;
+					self.buckets[slot(b)].push_back(r.dest);
+				}
+			sender.out[t].clear();
+		}
+	}
+
+	void run(unsigned t) {
+		workerState& self = workers[t];
+		phaseBarrier& barrier = *this->barrier;
+		while (true) {
+			//  Лёгкие рёбра - пока текущая корзина не опустеет
+			do {
+				generateLight(self);
+				barrier.wait();
+				apply(t);
+				self.nonEmpty = !self.buckets[slot(current)].empty();
+				barrier.wait([this] {
+					again = false;
+					for (const workerState& w : workers)
+						again = again || w.nonEmpty;
+					//  Корзина обработана - все расстояния меньше (current+1)*delta окончательные
+					if (!again && dist[finish] != std::numeric_limits<weight_type>::max() && bucketIndex(dist[finish]) <= current)
+						done = true;
+				});
+			} while (again);
+			if (done) break;
+
+			//  Тяжёлые рёбра - один раз на корзину
+			generateHeavy(self);
+			barrier.wait();
+			apply(t);
+
+			//  Следующая непустая корзина - все живые корзины в пределах slots от текущей
+			self.next = npos;
+			for (size_type b = current + 1; b < current + slots; ++b)
+				if (!self.buckets[slot(b)].empty()) {
+					self.next = b;
+					break;
+				}
+			barrier.wait([this] {
+				current = npos;
+				for (const workerState& w : workers)
+					current = std::min(current, w.next);
+				done = current == npos;
+			});
+			if (done) break;
+		}
+	}
+};
@@ -14,6 +14,18 @@
 //    - вершина графа должна предоставлять константные итераторы cbegin и cend для обхода смежных вершин
 //    - вершины графа нумеруются от 0 до V-1 (где V - количество вершин графа), без "дырок"
 //    - вершина графа имеет поле size_type name, определяющее номер вершины
+//    - вершина может определять distance_type - тип для длин путей (шире узкого weight_type, чтобы сумма
+//      весов не переполнялась); если его нет, то длины путей считаются в weight_type
+//
+//  Очередь с приоритетами - параметр шаблона Dijkstra (стратегия). Стратегия - шаблон от типа
+//  обёртки вершины (graphVertex), работающий с номерами вершин и ключами:
+//    - attach(nodes)              - привязка к вектору обёрток вершин (вызывается один раз);
+//    - push(id, key), decreaseKey(id, key) - добавление вершины и уменьшение её ключа;
+//    - top(), pop(), empty(), clear()      - номер вершины с минимальным ключом и т.д.
+//  По умолчанию используется binaryHeapQueue - обёртка над ExtPriority_Queue ниже.
+//  Для сбора статистики (см. SearchStats.h) у push, decreaseKey и pop должны быть перегрузки
+//  с дополнительным аргументом - объектом статистики, в который очередь сообщает шаги просеивания.
+//  Без статистики эти перегрузки не нужны.
 //---------------------------------------------------------------------------------------------------------
 
 #pragma once
@@ -21,6 +33,12 @@
 #include <vector>
 #include <functional>
 #include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <iostream>
+#include <chrono>
+#include <type_traits>
+#include "SearchStats.h"
 
 //---------------------------------------------------------------------------------------------------------
 //  Элемент очереди - легковесная структура, по сути просто указатель на обёртку над вершин
@@ -63,7 +81,8 @@ class ExtPriority_Queue {
 	//  "Топим" элемент в куче до его места. Считаем, что у элемента index в дочерних поддеревьях всё хорошо,
 	//  и свойство кучи не выполняется только в самом элементе - его надо "утопить" до его правильного места,
 	//  меняя местами с максимальным из дочерних узлов.
-	void heapify(size_type index) noexcept {
+	template<typename statsType>
+	void heapify(size_type index, statsType& stats) noexcept {
 		size_type max_index{ index };
 		size_type size{ cont.size() };
 
@@ -82,6 +101,7 @@ class ExtPriority_Queue {
 			std::swap(cont[index], cont[max_index]);
 			//  Родительская структура должна знать, что элемент перемещён на новое место
 			cont[index].update_index(index);
+			stats.countSiftStep();
 
 			index = max_index;
 		}
@@ -102,22 +122,35 @@ public:
 	}
 
 	void push(T& elem) noexcept {
+		noStats none;
+		push(elem, none);
+	}
+
+	//  То же со сбором статистики просеивания (см. SearchStats.h)
+	template<typename statsType>
+	void push(T& elem, statsType& stats) noexcept {
 		//  Добавляем элемент в конец очереди, и вызываем DecreaseKey
 		cont.push_back(queueElem<T>(elem));
 		//  Здесь надо осторожно! Размещённый элемент имеет неверный index, и это должна поправить функция
 		//  decreaseKey - там обязательно надо сделать обновление индекса
-		decreaseKey(cont.size() - 1);
+		decreaseKey(cont.size() - 1, stats);
 	}
 	
 	//  Извлечение элемента из начала очереди
 	void pop() noexcept {
+		noStats none;
+		pop(none);
+	}
+
+	template<typename statsType>
+	void pop(statsType& stats) noexcept {
 		//  Заменяем начальный элемент последним
 		cont[0] = std::move(cont[cont.size() - 1]);
 		//  Последний тихо-мирно оставляем за бортом (его уже в начало перенесли)
 		cont.pop_back();
 		if (cont.size() == 0) return;
 		//  Внутри обязателен вызов update_index
-		heapify(0);
+		heapify(0, stats);
 	}
 	
 	//  Это в пояснениях не нуждается
@@ -127,10 +160,17 @@ public:
 
 	//  Считаем, что обновился индекс у элемента, и его надо переместить на нужное место
 	void decreaseKey(size_type index) noexcept {
+		noStats none;
+		decreaseKey(index, none);
+	}
+
+	template<typename statsType>
+	void decreaseKey(size_type index, statsType& stats) noexcept {
 		while (index > 0 && cmp(cont[parent(index)], cont[index])) {
 			std::swap(cont[index], cont[parent(index)]);
 			//  И обновляем индексы подвинутых вершин
 			cont[index].update_index(index);
+			stats.countSiftStep();
 			index = parent(index);
 		}
 		cont[index].update_index(index);
@@ -138,6 +178,9 @@ public:
 
 	inline bool empty() const { return cont.empty(); }
 
+	//  Очистка очереди без освобождения памяти - при повторных запросах контейнер не перевыделяется
+	inline void clear() noexcept { cont.clear(); }
+
 	//  Отладочная печать - можно и выкинуть
 	void print() const {
 		std::cout << "PQueue size " << cont.size() << std::endl;
@@ -153,21 +196,33 @@ public:
 //-------------------------------------------------------------------------------
 
 //  Состояние вершины в алгоритме Дейкстры - неизвестно, открыта, закрыта
-enum class vertexState {None, Opened, Finished};
+enum class vertexState : unsigned char {None, Opened, Finished};
+
+//  Тип длин путей для вершины: distance_type, если вершина его определяет, иначе weight_type
+template<typename vertexType, typename = void>
+struct distanceOf {
+	using type = typename vertexType::weight_type;
+};
+template<typename vertexType>
+struct distanceOf<vertexType, std::void_t<typename vertexType::distance_type>> {
+	using type = typename vertexType::distance_type;
+};
 
 //  Обёртка для вершин графа, использующаяся в алгоритме Дейкстры
-//  Хранит все необходимые поля, а также привязана к узлам двоичной кучи
+//  Хранит все необходимые поля, а также привязана к узлам двоичной кучи.
+//  weight_type обёртки - тип длин путей (метка вершины), а не веса ребра.
+//  Поля - в типах графа, так что при 32-битных индексах обёртка заметно меньше
 template<typename vertexType>
 struct graphVertex {
 	using size_type = typename vertexType::size_type;
-	using weight_type = typename vertexType::weight_type;
+	using weight_type = typename distanceOf<vertexType>::type;
 
 	const vertexType * vertex;
 	size_type parent;
 	weight_type weight;
 	vertexState state;
-	size_t index;
-	graphVertex(const vertexType& graphVertex, size_t queueIndex = std::numeric_limits<size_type>::max()) noexcept :
+	size_type index;
+	graphVertex(const vertexType& graphVertex, size_type queueIndex = std::numeric_limits<size_type>::max()) noexcept :
 		vertex(&graphVertex),
 		parent(std::numeric_limits<size_type>::max()),
 		weight(std::numeric_limits<weight_type>::max()),
@@ -175,24 +230,264 @@ struct graphVertex {
 		index(queueIndex)
 	{}
 
-	inline void update_index(size_t new_index) { index = new_index; }
+	inline void update_index(size_t new_index) { index = static_cast<size_type>(new_index); }
 
 	inline bool operator<(const graphVertex<vertexType>& other) const { return weight < other.weight; }
 	inline bool operator>(const graphVertex<vertexType>& other) const { return weight > other.weight; }
 
 };
 
-//  Адаптер для алгоритма Дейкстры
-template<typename vertexType>
+//  Стратегия очереди по умолчанию - двоичная куча из указателей на обёртки вершин.
+//  Ключ хранится в самой обёртке (поле weight), поэтому в push и decreaseKey он не нужен
+template<typename nodeType>
+class binaryHeapQueue {
+	using size_type = typename nodeType::size_type;
+	using weight_type = typename nodeType::weight_type;
+	using queueElemType = queueElem<nodeType>;
+
+	std::vector<nodeType>* nodes = nullptr;
+	ExtPriority_Queue<nodeType, std::vector<queueElemType>, std::greater<queueElemType>> epq;
+
+public:
+	inline void attach(std::vector<nodeType>& Nodes) noexcept { nodes = &Nodes; }
+
+	inline void push(size_type id, weight_type) noexcept { epq.push((*nodes)[id]); }
+	inline void decreaseKey(size_type id, weight_type) noexcept { epq.decreaseKey((*nodes)[id].index); }
+
+	template<typename statsType>
+	inline void push(size_type id, weight_type, statsType& stats) noexcept { epq.push((*nodes)[id], stats); }
+	template<typename statsType>
+	inline void decreaseKey(size_type id, weight_type, statsType& stats) noexcept { epq.decreaseKey((*nodes)[id].index, stats); }
+	template<typename statsType>
+	inline void pop(statsType& stats) noexcept { epq.pop(stats); }
+
+	inline size_type top() const { return epq.top().vertex->name; }
+	inline void pop() noexcept { epq.pop(); }
+	inline bool empty() const { return epq.empty(); }
+	inline void clear() noexcept { epq.clear(); }
+};
+
+//  Дерево кратчайших путей от одной вершины: расстояния и родители для всех вершин графа.
+//  Для недостижимых вершин оба поля равны максимальному значению типа, родитель стартовой - она сама
+template<typename size_type, typename weight_type>
+struct shortestPathTree {
+	size_type start = std::numeric_limits<size_type>::max();
+	std::vector<weight_type> weight;
+	std::vector<size_type> parent;
+
+	bool reached(size_type index) const noexcept { return parent[index] != std::numeric_limits<size_type>::max(); }
+
+	//  Путь от стартовой вершины до index (пустой, если index недостижима)
+	std::vector<size_type> path(size_type index) const {
+		std::vector<size_type> result;
+		if (!reached(index)) return result;
+		result.push_back(index);
+		while (index != start) {
+			index = parent[index];
+			result.push_back(index);
+		}
+		std::reverse(result.begin(), result.end());
+		return result;
+	}
+};
+
+//  Сохранённое начало поиска от одной вершины - закрытые вершины (отсортированы по номеру) и граница
+//  (открытые вершины с их текущими оценками). По нему можно сразу ответить для закрытых вершин или
+//  продолжить поиск (Dijkstra::calcPathFrom). Пустое начало - поиск ещё не начинался
+template<typename size_type, typename weight_type>
+struct searchPrefix {
+	static constexpr size_type npos = std::numeric_limits<size_type>::max();
+
+	size_type start = npos;
+	std::vector<size_type> settled;
+	std::vector<weight_type> settledWeight;
+	std::vector<size_type> settledParent;
+	std::vector<size_type> frontier;
+	std::vector<weight_type> frontierWeight;
+	std::vector<size_type> frontierParent;
+
+	bool empty() const noexcept { return settled.empty() && frontier.empty(); }
+	//  Граница пуста - закрыто всё, что достижимо из start
+	bool complete() const noexcept { return !settled.empty() && frontier.empty(); }
+
+	//  Место вершины среди закрытых (npos, если она не закрыта)
+	size_type find(size_type index) const noexcept {
+		auto it = std::lower_bound(settled.begin(), settled.end(), index);
+		return it != settled.end() && *it == index ? static_cast<size_type>(it - settled.begin()) : npos;
+	}
+
+	//  Путь до закрытой вершины и его стоимость (пустой путь, если вершина не закрыта)
+	std::pair<std::vector<size_type>, weight_type> path(size_type index) const {
+		size_type pos = find(index);
+		if (pos == npos)
+			return make_pair(std::vector<size_type>(), weight_type(0));
+		const weight_type w = settledWeight[pos];
+		std::vector<size_type> result;
+		result.push_back(index);
+		while (index != start) {
+			index = settledParent[find(index)];
+			result.push_back(index);
+		}
+		std::reverse(result.begin(), result.end());
+		return make_pair(result, w);
+	}
+
+	//  Примерный объём памяти
+	size_t bytes() const noexcept {
+		return sizeof(*this) + (settled.size() + frontier.size()) * (2 * sizeof(size_type) + sizeof(weight_type));
+	}
+};
+
+//  Адаптер для алгоритма Дейкстры. statsPolicy - сбор статистики запросов (SearchStats.h), по умолчанию выключен
+template<typename vertexType, template<typename> class queuePolicy = binaryHeapQueue, typename statsPolicy = noStats>
 class Dijkstra {
 private:
 	
 	//  Типы для индексов и весов
 	using size_type = typename graphVertex<vertexType>::size_type;
 	using weight_type = typename graphVertex<vertexType>::weight_type;
-	
+
 	//  Информация об адаптерах вершин хранится в 
 	std::vector<graphVertex<vertexType>> nodes;
+
+	//  Очередь живёт между запросами, чтобы не перевыделять её память каждый раз
+	queuePolicy<graphVertex<vertexType>> epq;
+
+	//  Вершины, которые затронул последний запрос. Перед новым запросом сбрасываем только их,
+	//  так что стоимость сброса пропорциональна области поиска, а не размеру графа
+	std::vector<size_type> touched;
+
+	//  Отмечаем вершину как затронутую (вызывается при первом открытии вершины)
+	inline void touch(size_type index) { touched.push_back(index); }
+
+	//  Возвращаем затронутые прошлым запросом вершины в исходное состояние
+	void reset() noexcept {
+		for (size_type index : touched) {
+			graphVertex<vertexType>& node = nodes[index];
+			node.parent = std::numeric_limits<size_type>::max();
+			node.weight = std::numeric_limits<weight_type>::max();
+			node.state = vertexState::None;
+			node.index = std::numeric_limits<size_type>::max();
+		}
+		touched.clear();
+		epq.clear();
+	}
+
+	//  Статистика последнего запроса и функция, которой она передаётся после каждого запроса
+	statsPolicy lastStats;
+	std::function<void(const statsPolicy&)> statsCallback;
+	std::chrono::steady_clock::time_point timer;
+
+	//  Операции очереди. Без статистики это прямые вызовы, со статистикой очередь получает
+	//  объект статистики, чтобы сообщать о шагах просеивания
+	inline void queuePush(size_type id, weight_type key) {
+		if constexpr (statsPolicy::enabled) {
+			lastStats.countPush();
+			epq.push(id, key, lastStats);
+		}
+		else
+			epq.push(id, key);
+	}
+	inline void queueDecreaseKey(size_type id, weight_type key) {
+		if constexpr (statsPolicy::enabled) {
+			lastStats.countDecreaseKey();
+			epq.decreaseKey(id, key, lastStats);
+		}
+		else
+			epq.decreaseKey(id, key);
+	}
+	inline void queuePop() {
+		if constexpr (statsPolicy::enabled) {
+			lastStats.countPop();
+			epq.pop(lastStats);
+		}
+		else
+			epq.pop();
+	}
+
+	//  Отметки времени: начало запроса, конец поиска (начало восстановления пути), конец запроса
+	inline void beginQuery() {
+		if constexpr (statsPolicy::enabled) {
+			lastStats.clear();
+			lastStats.queries = 1;
+			timer = std::chrono::steady_clock::now();
+		}
+	}
+	inline void beginPath() {
+		if constexpr (statsPolicy::enabled) {
+			auto now = std::chrono::steady_clock::now();
+			lastStats.searchSeconds = std::chrono::duration<double>(now - timer).count();
+			timer = now;
+		}
+	}
+	inline void endQuery() {
+		if constexpr (statsPolicy::enabled) {
+			lastStats.pathSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - timer).count();
+			if (statsCallback)
+				statsCallback(lastStats);
+		}
+	}
+
+	//  Стартовая вершина последнего поиска (для pathTo)
+	size_type lastStart = std::numeric_limits<size_type>::max();
+
+	//  Отметки целевых вершин для поиска "один ко многим" - заводятся при первом таком запросе
+	std::vector<char> isTarget;
+
+	//  Поиск без фиксированной цели: вершины закрываются в порядке возрастания расстояния, после закрытия
+	//  каждой и релаксации её рёбер вызывается stop(index) - если он вернул true, поиск прекращается
+	template<typename stopFunc>
+	void search(size_type startIndex, stopFunc stop) {
+		if (startIndex >= nodes.size())
+			throw std::out_of_range("Wrong start node index!");
+
+		beginQuery();
+		reset();
+		lastStart = startIndex;
+
+		nodes[startIndex].parent = startIndex;
+		nodes[startIndex].weight = 0;
+		nodes[startIndex].state = vertexState::Opened;
+		touch(startIndex);
+		queuePush(startIndex, 0);
+
+		continueSearch(stop);
+	}
+
+	//  Основной цикл search - продолжается с того состояния вершин и очереди, которое есть сейчас
+	template<typename stopFunc>
+	void continueSearch(stopFunc stop) {
+		while (!epq.empty()) {
+			const graphVertex<vertexType>& current(nodes[epq.top()]);
+			queuePop();
+
+			size_type currentIndex = current.vertex->name;
+			nodes[currentIndex].state = vertexState::Finished;
+			lastStats.countSettled();
+
+			for (auto adjIt = current.vertex->cbegin(); adjIt != current.vertex->cend(); ++adjIt) {
+				lastStats.countEdge();
+				graphVertex<vertexType>& next = nodes[adjIt->dest];
+				weight_type candidate = current.weight + adjIt->weight;
+				if (next.state == vertexState::None) {
+					next.state = vertexState::Opened;
+					touch(adjIt->dest);
+					next.parent = currentIndex;
+					next.weight = candidate;
+					queuePush(adjIt->dest, candidate);
+				}
+				else if (next.state != vertexState::Finished && next.weight > candidate) {
+					next.weight = candidate;
+					next.parent = currentIndex;
+					queueDecreaseKey(adjIt->dest, candidate);
+				}
+			}
+			//  Останавливаемся только после релаксации рёбер: закрытая вершина всегда раскрыта,
+			//  иначе prefix() сохранил бы её закрытой, а продолженный поиск её рёбра так и не увидел бы
+			if (stop(currentIndex)) break;
+		}
+		beginPath();
+	}
 public:
 	//  Конструктор - просто цепляется к существующему графу
 	//  считаем, что в исходном графе индексация с 0, индексы соответствуют
@@ -200,6 +495,7 @@ public:
 	Dijkstra(vertexIter & begin, vertexIter & end) {
 		for (auto it = begin; it != end; ++it)
 			nodes.push_back(graphVertex<vertexType>(*it));
+		epq.attach(nodes);
 	}
 
 	//  Конструктор - просто цепляется к существующему графу
@@ -207,22 +503,56 @@ public:
 	explicit Dijkstra(const vertexCont & cont) {
 		for (auto it = cont.cbegin(); it != cont.cend(); ++it)
 			nodes.push_back(graphVertex<vertexType>(*it));
+		epq.attach(nodes);
 	}
 
-	//  Собственно, сам алгоритм Дейкстры - ищем последовательность индексов вершин, и стоимость пути
+	//  Очередь ссылается на вектор обёрток, поэтому копировать адаптер нельзя, а при перемещении
+	//  очередь перепривязывается (буфер вектора при перемещении не меняется)
+	Dijkstra(const Dijkstra&) = delete;
+	Dijkstra& operator=(const Dijkstra&) = delete;
+	Dijkstra(Dijkstra&& other) noexcept :
+		nodes(std::move(other.nodes)), epq(std::move(other.epq)), touched(std::move(other.touched)),
+		lastStats(other.lastStats), statsCallback(std::move(other.statsCallback)), timer(other.timer),
+		lastStart(other.lastStart), isTarget(std::move(other.isTarget)) {
+		epq.attach(nodes);
+	}
+
+	//  Количество вершин, затронутых последним запросом
+	size_type touchedCount() const noexcept { return touched.size(); }
+
+	//  Количество вершин, закрытых последним запросом - считается по списку затронутых,
+	//  чтобы не добавлять счётчик в сам поиск
+	size_type settledCount() const noexcept {
+		size_type result = 0;
+		for (size_type index : touched)
+			if (nodes[index].state == vertexState::Finished)
+				++result;
+		return result;
+	}
+
+	//  Статистика последнего запроса (при statsPolicy = noStats - пустая)
+	const statsPolicy& stats() const noexcept { return lastStats; }
+
+	//  Функция, которая получает статистику после каждого запроса - например, для суммирования
+	void setStatsCallback(std::function<void(const statsPolicy&)> callback) { statsCallback = std::move(callback); }
+
+	//  Собственно, сам алгоритм Дейкстры - ищем последовательность индексов вершин, и стоимость пути.
+	//  Объект можно использовать для любого количества запросов - состояние прошлого запроса сбрасывается
 	std::pair<std::vector<size_type>, weight_type> calcPath(size_type startIndex, size_type finishIndex) {
 		//  Сначала создаём очередь с приоритетом и пихаем туда стартовую вершину
 		if (startIndex >= nodes.size() || finishIndex >= nodes.size())
 			throw std::out_of_range("Wrong start or finish node index!");
 
-		using queueElemType = queueElem<graphVertex<vertexType>>;
+		beginQuery();
+		reset();
+		lastStart = startIndex;
 
-		ExtPriority_Queue <graphVertex<vertexType>, std::vector<queueElemType>, std::greater<queueElemType> > epq;
 		//  Задаём стартовую вершинку, и в очередь её, родимую
 		nodes[startIndex].parent = startIndex;
 		nodes[startIndex].weight = 0;
 		nodes[startIndex].state = vertexState::Opened;
-		epq.push(nodes[startIndex]);
+		touch(startIndex);
+		queuePush(startIndex, 0);
 
 		//  Спорное решение - остановить алгоритм в случае, если вершины на выходе имеют оценку больше целевой -
 		//    в таком случае целевую мы никогда не улучшим, и можно заканчивать
@@ -231,15 +561,17 @@ public:
 		while (!epq.empty()) {
 			//  Вытаскиваем очередную вершину из очереди (у неё на данный момент минимальная оценка)
 			
-			//  В обморок не падать!!!! top возвращает не ссылку на голову очереди, а элемент, на который
-			//  ссылается голова очереди, так что начало очереди спокойно можно удалить, ссылка будет живой
-			const graphVertex<vertexType> &current(epq.top());
+			//  Очередь отдаёт номер вершины, а сама обёртка вершины живёт в nodes,
+			//  так что начало очереди спокойно можно удалить, ссылка будет живой
+			const graphVertex<vertexType> &current(nodes[epq.top()]);
 			record = current.weight;  //  обновляем значение минимума отметок вершин в очереди
-			epq.pop();
+			queuePop();
+			lastStats.countSettled();
 
 			//  Если текущая вершина целевая, или же у неё оценка больше либо равна оценки целевой, то выходим
 			if (current.vertex->name == finishIndex || nodes[finishIndex].weight < record)
 			{
+				beginPath();
 				//  Строим путь по меткам родителей
 				std::vector<size_type> path;
 				size_type nodeIndex(finishIndex);
@@ -249,32 +581,193 @@ public:
 					path.push_back(nodeIndex);
 				}
 				std::reverse(path.begin(), path.end());
-				return make_pair(path, current.weight);
+				endQuery();
+				return make_pair(path, nodes[finishIndex].weight);
 			}
 			
 			//  Маркируем текущую вершину как закрытую
 			nodes[current.vertex->name].state = vertexState::Finished;
 
 			//  Для всех связанных с текущей
-			for (auto adjIt = current.vertex->cbegin(); adjIt != current.vertex->cend(); ++adjIt)
+			for (auto adjIt = current.vertex->cbegin(); adjIt != current.vertex->cend(); ++adjIt) {
+				lastStats.countEdge();
 				if (nodes[adjIt->dest].state == vertexState::None) {
 					//  Эту вершину ещё не открывали, её в любом случае в очередь добавляем
 					nodes[adjIt->dest].state = vertexState::Opened;
+					touch(adjIt->dest);
 					nodes[adjIt->dest].parent = current.vertex->name;
 					nodes[adjIt->dest].weight = nodes[current.vertex->name].weight + adjIt->weight;
-					epq.push(nodes[adjIt->dest]);
+					queuePush(adjIt->dest, nodes[adjIt->dest].weight);
 				}
 				else {
 					//  Уже открывали, пересчитываем - может быть, оценка уменьшится
 					if (nodes[adjIt->dest].state != vertexState::Finished && nodes[adjIt->dest].weight > nodes[current.vertex->name].weight + adjIt->weight) {
 						nodes[adjIt->dest].weight = nodes[current.vertex->name].weight + adjIt->weight;
 						nodes[adjIt->dest].parent = current.vertex->name;
-						epq.decreaseKey(nodes[adjIt->dest].index);
+						queueDecreaseKey(adjIt->dest, nodes[adjIt->dest].weight);
 					}
 				}
+			}
 		}
 		//  Если мы сюда попали, то всё плохо - пути не существует
+		beginPath();
+		endQuery();
 		return make_pair(std::vector<size_type>(), 0);
 
 	}
+
+	//  Один ко всем: полный поиск от стартовой вершины, расстояния и родители для всех вершин
+	shortestPathTree<size_type, weight_type> calcTree(size_type startIndex) {
+		search(startIndex, [](size_type) { return false; });
+
+		shortestPathTree<size_type, weight_type> tree;
+		tree.start = startIndex;
+		tree.weight.assign(nodes.size(), std::numeric_limits<weight_type>::max());
+		tree.parent.assign(nodes.size(), std::numeric_limits<size_type>::max());
+		//  Достижимы ровно затронутые вершины - копируем только их
+		for (size_type index : touched) {
+			tree.weight[index] = nodes[index].weight;
+			tree.parent[index] = nodes[index].parent;
+		}
+		endQuery();
+		return tree;
+	}
+
+	//  Один ко многим: поиск останавливается, когда закрыты все целевые вершины.
+	//  Возвращает расстояния в порядке targets (максимальное значение типа - вершина недостижима).
+	//  Пути до целей после этого можно получить через pathTo
+	std::vector<weight_type> calcDistances(size_type startIndex, const std::vector<size_type>& targets) {
+		//  Все проверки - до отметок целей: исключение после них оставило бы отметки в isTarget,
+		//  и следующие запросы останавливались бы на чужих целях
+		if (startIndex >= nodes.size())
+			throw std::out_of_range("Wrong start node index!");
+		for (size_type target : targets)
+			if (target >= nodes.size())
+				throw std::out_of_range("Wrong target node index!");
+		if (targets.empty())
+			return std::vector<weight_type>();
+
+		if (isTarget.size() != nodes.size())
+			isTarget.assign(nodes.size(), 0);
+
+		//  Повторяющиеся цели считаем один раз
+		size_type remaining = 0;
+		for (size_type target : targets)
+			if (!isTarget[target]) {
+				isTarget[target] = 1;
+				++remaining;
+			}
+
+		search(startIndex, [this, &remaining](size_type index) {
+			return isTarget[index] && --remaining == 0;
+		});
+
+		std::vector<weight_type> result;
+		result.reserve(targets.size());
+		for (size_type target : targets) {
+			isTarget[target] = 0;
+			result.push_back(nodes[target].state == vertexState::Finished ? nodes[target].weight : std::numeric_limits<weight_type>::max());
+		}
+		endQuery();
+		return result;
+	}
+
+	//  Многие ко многим: таблица расстояний sources.size() x targets.size() по строкам,
+	//  одна остановка "один ко многим" на каждый источник
+	std::vector<weight_type> distanceTable(const std::vector<size_type>& sources, const std::vector<size_type>& targets) {
+		std::vector<weight_type> table;
+		table.reserve(sources.size() * targets.size());
+		for (size_type source : sources) {
+			std::vector<weight_type> row(calcDistances(source, targets));
+			table.insert(table.end(), row.begin(), row.end());
+		}
+		return table;
+	}
+
+	//  Путь до вершины, закрытой последним поиском (пустой, если она не закрыта)
+	std::vector<size_type> pathTo(size_type finishIndex) const {
+		std::vector<size_type> path;
+		if (finishIndex >= nodes.size() || nodes[finishIndex].state != vertexState::Finished)
+			return path;
+		path.push_back(finishIndex);
+		while (finishIndex != lastStart) {
+			finishIndex = nodes[finishIndex].parent;
+			path.push_back(finishIndex);
+		}
+		std::reverse(path.begin(), path.end());
+		return path;
+	}
+
+	//  Состояние последнего поиска (calcTree, calcDistances, calcPathFrom) как начало поиска от его
+	//  стартовой вершины - для кэширования и продолжения через calcPathFrom
+	searchPrefix<size_type, weight_type> prefix() const {
+		searchPrefix<size_type, weight_type> result;
+		result.start = lastStart;
+		std::vector<size_type> finished;
+		for (size_type index : touched)
+			if (nodes[index].state == vertexState::Finished)
+				finished.push_back(index);
+			else {
+				result.frontier.push_back(index);
+				result.frontierWeight.push_back(nodes[index].weight);
+				result.frontierParent.push_back(nodes[index].parent);
+			}
+		std::sort(finished.begin(), finished.end());
+		result.settledWeight.reserve(finished.size());
+		result.settledParent.reserve(finished.size());
+		for (size_type index : finished) {
+			result.settledWeight.push_back(nodes[index].weight);
+			result.settledParent.push_back(nodes[index].parent);
+		}
+		result.settled = std::move(finished);
+		return result;
+	}
+
+	//  Путь от сохранённого начала поиска saved до finishIndex: закрытые вершины и граница загружаются, и поиск
+	//  продолжается, пока не будет закрыта finishIndex. Пустое начало - обычный поиск от saved.start
+	std::pair<std::vector<size_type>, weight_type> calcPathFrom(const searchPrefix<size_type, weight_type>& saved, size_type finishIndex) {
+		if (saved.start >= nodes.size() || finishIndex >= nodes.size())
+			throw std::out_of_range("Wrong start or finish node index!");
+
+		auto stop = [finishIndex](size_type index) { return index == finishIndex; };
+		if (saved.empty())
+			search(saved.start, stop);
+		else {
+			beginQuery();
+			reset();
+			lastStart = saved.start;
+			for (size_type i = 0; i < saved.settled.size(); ++i) {
+				graphVertex<vertexType>& node = nodes[saved.settled[i]];
+				node.weight = saved.settledWeight[i];
+				node.parent = saved.settledParent[i];
+				node.state = vertexState::Finished;
+				touch(saved.settled[i]);
+			}
+			//  Границу кладём в очередь по возрастанию ключей: монотонные очереди (MonotoneQueues.h)
+			//  считают первый ключ после clear() минимальным и отсчитывают корзины от него
+			std::vector<size_type> order(saved.frontier.size());
+			for (size_type i = 0; i < order.size(); ++i)
+				order[i] = i;
+			std::stable_sort(order.begin(), order.end(), [&saved](size_type a, size_type b) {
+				return saved.frontierWeight[a] < saved.frontierWeight[b];
+			});
+			for (size_type i : order) {
+				graphVertex<vertexType>& node = nodes[saved.frontier[i]];
+				node.weight = saved.frontierWeight[i];
+				node.parent = saved.frontierParent[i];
+				node.state = vertexState::Opened;
+				touch(saved.frontier[i]);
+				queuePush(saved.frontier[i], node.weight);
+			}
+			if (nodes[finishIndex].state != vertexState::Finished)
+				continueSearch(stop);
+			else
+				beginPath();
+		}
+
+		std::vector<size_type> path(pathTo(finishIndex));
+		weight_type w = path.empty() ? weight_type(0) : nodes[finishIndex].weight;
+		endQuery();
+		return make_pair(std::move(path), w);
+	}
 };
@@ -0,0 +1,76 @@
+//---------------------------------------------------------------------------------------------------------
+//  Клиент сервера запросов (DijkstraServer.cpp) для строчного протокола: строки из stdin отправляются
+//  в сокет, ответы печатаются в stdout. Отправка и приём идут параллельно, так что запросы уходят
+//  конвейером, не дожидаясь ответов.
+//
+//  Параметры:
+//    --socket path   сокет сервера
+//
+//  Пример: printf '1 9563\nstats\n' | DijkstraClient --socket /tmp/dijkstra.sock
+//---------------------------------------------------------------------------------------------------------
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include "ServerIO.h"
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+    string socketPath;
+    for (int i = 1; i < argc; i += 2) {
+        string key = argv[i];
+        if (i + 1 == argc) {
+            cerr << "Option " << key << " needs a value\n";
+            return 2;
+        }
+        string value = argv[i + 1];
+        if (key == "--socket") socketPath = value;
+        else {
+            cerr << "Unknown option " << key << "\n";
+            return 2;
+        }
+    }
+    if (socketPath.empty()) {
+        cerr << "Usage: DijkstraClient --socket path\n";
+        return 2;
+    }
+
+#if DIJKSTRA_UNIX_SOCKETS
+    int fd;
+    try {
+        fd = connectUnix(socketPath);
+    }
+    catch (const exception& e) {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    //  Запросы - в отдельном потоке; после конца stdin закрываем свою сторону, сервер допишет ответы
+    thread sender([fd] {
+        fdReader input(0);
+        string line;
+        while (input.readLine(line)) {
+            line.push_back('\n');
+            if (!writeAll(fd, line.data(), line.size()))
+                break;
+        }
+        ::shutdown(fd, SHUT_WR);
+    });
+
+    fdReader replies(fd);
+    string line;
+    while (replies.readLine(line)) {
+        line.push_back('\n');
+        if (!writeAll(1, line.data(), line.size()))
+            break;
+    }
+    sender.join();
+    ::close(fd);
+    return 0;
+#else
+    cerr << "Unix domain sockets are not supported on this platform\n";
+    return 2;
+#endif
+}
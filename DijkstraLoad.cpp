@@ -0,0 +1,198 @@
+//---------------------------------------------------------------------------------------------------------
+//  Генератор нагрузки для сервера запросов (DijkstraServer.cpp): отправляет случайные запросы через
+//  сокет Unix, держа в полёте не больше --window запросов, и меряет задержку каждого ответа (от отправки
+//  до получения) и общую пропускную способность. Запросы - от mt19937_64 с заданным зерном, так что
+//  прогоны повторяемы. Код возврата 1, если сервер ответил ошибкой или оборвал соединение.
+//
+//  Параметры:
+//    --socket path           сокет сервера
+//    --protocol line|binary  протокол (как у сервера)
+//    --queries 10000         количество запросов
+//    --window 64             запросов в полёте
+//    --vertices 0            количество вершин графа; для строчного протокола можно не задавать -
+//                            оно берётся из ответа на stats
+//    --seed 1                зерно запросов
+//---------------------------------------------------------------------------------------------------------
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include "ServerIO.h"
+
+using namespace std;
+
+using loadClock = chrono::steady_clock;
+
+//  Перцентиль по ближайшему рангу (latencies отсортирован)
+static double percentile(const vector<double>& latencies, double p) {
+    if (latencies.empty()) return 0;
+    size_t rank = static_cast<size_t>(p / 100.0 * latencies.size() + 0.5);
+    return latencies[min(latencies.size() - 1, rank == 0 ? 0 : rank - 1)];
+}
+
+int main(int argc, char* argv[])
+{
+    string socketPath;
+    bool binary = false;
+    size_t queryCount = 10000;
+    size_t window = 64;
+    unsigned long long vertices = 0;
+    unsigned long long seed = 1;
+
+    for (int i = 1; i < argc; i += 2) {
+        string key = argv[i];
+        if (i + 1 == argc) {
+            cerr << "Option " << key << " needs a value\n";
+            return 2;
+        }
+        string value = argv[i + 1];
+        if (key == "--socket") socketPath = value;
+        else if (key == "--protocol") binary = value == "binary";
+        else if (key == "--queries") queryCount = stoull(value);
+        else if (key == "--window") window = max<size_t>(1, stoull(value));
+        else if (key == "--vertices") vertices = stoull(value);
+        else if (key == "--seed") seed = stoull(value);
+        else {
+            cerr << "Unknown option " << key << "\n";
+            return 2;
+        }
+    }
+    if (socketPath.empty()) {
+        cerr << "Usage: DijkstraLoad --socket path [--protocol line|binary] [--queries N] [--window W]\n";
+        return 2;
+    }
+
+#if DIJKSTRA_UNIX_SOCKETS
+    int fd;
+    try {
+        fd = connectUnix(socketPath);
+    }
+    catch (const exception& e) {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    fdReader replies(fd);
+
+    if (vertices == 0) {
+        if (binary) {
+            cerr << "--vertices is required for the binary protocol\n";
+            return 2;
+        }
+        string request = "stats\n", line, word;
+        if (!writeAll(fd, request.data(), request.size()) || !replies.readLine(line)) {
+            cerr << "Server closed the connection\n";
+            return 1;
+        }
+        istringstream in(line);
+        while (in >> word)
+            if (word == "vertices") in >> vertices;
+        if (vertices == 0) {
+            cerr << "Can't get the vertex count from: " << line << "\n";
+            return 1;
+        }
+    }
+
+    mt19937_64 rng(seed);
+    vector<pair<unsigned long long, unsigned long long>> queries(queryCount);
+    for (auto& q : queries)
+        q = make_pair(rng() % vertices, rng() % vertices);
+
+    //  Время отправки каждого запроса; отправитель не уходит дальше, чем на window запросов вперёд
+    vector<loadClock::time_point> sentAt(queryCount);
+    mutex guard;
+    condition_variable room;
+    size_t sent = 0, received = 0;
+    bool stop = false;
+
+    const auto start = loadClock::now();
+    thread sender([&] {
+        string buffer;
+        for (size_t i = 0; i < queryCount; ++i) {
+            {
+                unique_lock<mutex> lock(guard);
+                room.wait(lock, [&] { return stop || sent - received < window; });
+                if (stop) break;
+                sentAt[i] = loadClock::now();
+                ++sent;
+            }
+            buffer.clear();
+            if (binary) {
+                putU64(buffer, queries[i].first);
+                putU64(buffer, queries[i].second);
+            }
+            else
+                buffer = to_string(queries[i].first) + ' ' + to_string(queries[i].second) + '\n';
+            if (!writeAll(fd, buffer.data(), buffer.size()))
+                break;
+        }
+        ::shutdown(fd, SHUT_WR);
+    });
+
+    vector<double> latencies;
+    latencies.reserve(queryCount);
+    size_t unreachable = 0, errors = 0;
+    bool closed = false;
+    string line;
+    for (size_t i = 0; i < queryCount; ++i) {
+        bool ok = false, reached = false;
+        if (binary) {
+            unsigned char header[16];
+            if (replies.readExact(header, sizeof(header))) {
+                uint64_t cost = getU64(header), count = getU64(header + 8);
+                ok = !(cost == binaryNone && count == binaryNone);
+                reached = ok && cost != binaryNone;
+                vector<unsigned char> path(reached ? count * 8 : 0);
+                if (reached && !replies.readExact(path.data(), path.size()))
+                    closed = true;
+            }
+            else
+                closed = true;
+        }
+        else if (replies.readLine(line)) {
+            ok = line.compare(0, 5, "error") != 0;
+            reached = ok && line != "unreachable";
+        }
+        else
+            closed = true;
+        if (closed) break;
+
+        {
+            lock_guard<mutex> lock(guard);
+            latencies.push_back(chrono::duration<double>(loadClock::now() - sentAt[i]).count() * 1e6);
+            ++received;
+        }
+        room.notify_one();
+        if (!ok) ++errors;
+        else if (!reached) ++unreachable;
+    }
+    const double seconds = chrono::duration<double>(loadClock::now() - start).count();
+    {
+        lock_guard<mutex> lock(guard);
+        stop = true;
+    }
+    room.notify_one();
+    sender.join();
+    ::close(fd);
+
+    sort(latencies.begin(), latencies.end());
+    cout << "queries " << latencies.size() << " of " << queryCount << ", window " << window
+        << ", seconds " << seconds << ", throughput_qps " << (seconds > 0 ? latencies.size() / seconds : 0) << "\n"
+        << "latency_us p50 " << percentile(latencies, 50) << " p90 " << percentile(latencies, 90)
+        << " p99 " << percentile(latencies, 99) << " max " << (latencies.empty() ? 0 : latencies.back()) << "\n"
+        << "unreachable " << unreachable << ", errors " << errors << "\n";
+
+    if (closed)
+        cerr << "Server closed the connection early\n";
+    return closed || errors > 0 ? 1 : 0;
+#else
+    cerr << "Unix domain sockets are not supported on this platform\n";
+    return 2;
+#endif
+}
@@ -0,0 +1,260 @@
+//---------------------------------------------------------------------------------------------------------
+//  Сервер запросов кратчайших путей: граф загружается один раз, запросы приходят через stdin или
+//  сокет Unix (протоколы - в ServerIO.h), обрабатываются конвейером из QueryServer.h.
+//
+//  Параметры:
+//    --graph file.txt        граф в текстовом формате (Graph::saveToFile), загружается сразу в CSR
+//    --binary file.bin       граф в двоичном формате (BinaryGraph.h), отображается в память
+//    --generate 10000        случайный граф (Graph::generateGraph) с зерном --seed 1 - для проверок
+//    --socket path           слушать сокет Unix; без него - запросы из stdin, ответы в stdout
+//    --connections 0         для сокета: завершиться после стольких соединений (0 - работать всегда)
+//    --protocol line|binary  протокол
+//    --threads 0             рабочие потоки (0 - все ядра)
+//    --batch 64              сколько запросов рабочий поток забирает за раз
+//    --max-pending 65536     предел неотвеченных запросов
+//
+//  Пример: printf '1 9563\nstats\n' | DijkstraServer --graph Dijkstra.txt
+//---------------------------------------------------------------------------------------------------------
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <list>
+#include <atomic>
+#include <memory>
+#include <cstdlib>
+#include "Graph.h"
+#include "CSRGraph.h"
+#include "BinaryGraph.h"
+#include "DAryHeap.h"
+#include "Dijkstra.h"
+#include "QueryServer.h"
+#include "ServerIO.h"
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <cstdio>
+#endif
+
+using namespace std;
+
+struct serverOptions {
+    string graphFile;
+    string binaryFile;
+    size_t generate = 0;
+    unsigned seed = 1;
+    string socketPath;
+    size_t connections = 0;
+    bool binary = false;
+    unsigned threads = 0;
+    size_t batch = 64;
+    size_t maxPending = 65536;
+};
+
+using engine = Dijkstra<csrVertex, fourAryHeap>;
+
+//  Строчный протокол: "source target" или "stats"
+template<typename requestType>
+static requestType parseLine(const string& line) {
+    requestType request;
+    istringstream in(line);
+    string first;
+    in >> first;
+    if (first == "stats") {
+        request.type = requestType::kind::Stats;
+        return request;
+    }
+    istringstream numbers(line);
+    string rest;
+    if (!(numbers >> request.source >> request.target) || (numbers >> rest))
+        request.type = requestType::kind::Malformed;
+    return request;
+}
+
+template<typename responseType>
+static string formatLine(const responseType& r) {
+    ostringstream out;
+    if (!r.ok)
+        out << "error " << r.text;
+    else if (!r.text.empty())
+        out << "stats " << r.text;
+    else if (r.path.empty())
+        out << "unreachable";
+    else {
+        out << r.cost;
+        for (auto x : r.path)
+            out << ' ' << x;
+    }
+    out << '\n';
+    return out.str();
+}
+
+template<typename responseType>
+static string formatBinary(const responseType& r) {
+    string out;
+    if (!r.ok) {
+        putU64(out, binaryNone);
+        putU64(out, binaryNone);
+    }
+    else if (r.path.empty()) {
+        putU64(out, binaryNone);
+        putU64(out, 0);
+    }
+    else {
+        putU64(out, static_cast<uint64_t>(r.cost));
+        putU64(out, r.path.size());
+        for (auto x : r.path)
+            putU64(out, static_cast<uint64_t>(x));
+    }
+    return out;
+}
+
+//  Одно соединение (или stdin/stdout): запросы читаются и сразу уходят в конвейер, ответы пишет поток
+//  вывода queryStream по мере готовности. Если клиент перестал читать ответы, ждёт только поток вывода
+//  этого соединения, а после maxPending неотданных ответов и чтение запросов - рабочие потоки тем
+//  временем обслуживают другие соединения. Если клиент закрыл соединение, ответы отбрасываются
+template<typename pipelineType>
+static void serveConnection(pipelineType& pipeline, int inFd, int outFd, bool binary) {
+    using request = typename pipelineType::request;
+    using response = typename pipelineType::response;
+    using size_type = typename pipelineType::size_type;
+
+    bool broken = false;
+    queryStream<typename pipelineType::graph_type, typename pipelineType::engine_type> stream(pipeline, [&](const response& r) {
+        if (broken) return;
+        string out = binary ? formatBinary(r) : formatLine(r);
+        broken = !writeAll(outFd, out.data(), out.size());
+    });
+
+    fdReader reader(inFd);
+    if (binary) {
+        unsigned char buffer[16];
+        while (reader.readExact(buffer, sizeof(buffer))) {
+            request q;
+            uint64_t source = getU64(buffer), target = getU64(buffer + 8);
+            q.source = static_cast<size_type>(source);
+            q.target = static_cast<size_type>(target);
+            if (q.source != source || q.target != target)
+                q.type = request::kind::Malformed;
+            stream.submit(q);
+        }
+    }
+    else {
+        string line;
+        while (reader.readLine(line))
+            if (line.find_first_not_of(" \t") != string::npos)
+                stream.submit(parseLine<request>(line));
+    }
+    stream.finish();
+}
+
+template<typename graphType>
+static int serve(const graphType& G, const serverOptions& options) {
+    queryPipeline<graphType, engine> pipeline(G, options.threads, options.batch, options.maxPending);
+    cerr << "Graph: " << G.size() << " vertices, " << G.edgeCount() << " edges; "
+        << pipeline.threads() << " worker threads\n";
+
+    if (options.socketPath.empty()) {
+#if defined(_WIN32)
+        _setmode(_fileno(stdin), _O_BINARY);
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        serveConnection(pipeline, 0, 1, options.binary);
+    }
+    else {
+#if DIJKSTRA_UNIX_SOCKETS
+        int listener = listenUnix(options.socketPath);
+        cerr << "Listening on " << options.socketPath << "\n";
+        //  Потоки соединений; закончившиеся собираются при каждом новом соединении, чтобы при работе
+        //  без ограничения (--connections 0) список не рос вместе с числом обслуженных клиентов
+        struct client {
+            thread worker;
+            atomic<bool> done{ false };
+        };
+        list<client> clients;
+        for (size_t accepted = 0; options.connections == 0 || accepted < options.connections; ++accepted) {
+            int fd = ::accept(listener, nullptr, nullptr);
+            if (fd < 0) {
+                if (errno == EINTR) { --accepted; continue; }
+                break;
+            }
+            for (auto it = clients.begin(); it != clients.end(); )
+                if (it->done) {
+                    it->worker.join();
+                    it = clients.erase(it);
+                }
+                else
+                    ++it;
+            client& c = clients.emplace_back();
+            c.worker = thread([&pipeline, fd, &options, &c] {
+                serveConnection(pipeline, fd, fd, options.binary);
+                ::close(fd);
+                c.done = true;
+            });
+        }
+        for (client& c : clients)
+            c.worker.join();
+        ::close(listener);
+        ::unlink(options.socketPath.c_str());
+#else
+        cerr << "Unix domain sockets are not supported on this platform, use stdin\n";
+        return 2;
+#endif
+    }
+
+    cerr << "stats " << pipeline.statsLine() << "\n";
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    serverOptions options;
+    for (int i = 1; i < argc; i += 2) {
+        string key = argv[i];
+        if (i + 1 == argc) {
+            cerr << "Option " << key << " needs a value\n";
+            return 2;
+        }
+        string value = argv[i + 1];
+        if (key == "--graph") options.graphFile = value;
+        else if (key == "--binary") options.binaryFile = value;
+        else if (key == "--generate") options.generate = stoull(value);
+        else if (key == "--seed") options.seed = static_cast<unsigned>(stoul(value));
+        else if (key == "--socket") options.socketPath = value;
+        else if (key == "--connections") options.connections = stoull(value);
+        else if (key == "--protocol") options.binary = value == "binary";
+        else if (key == "--threads") options.threads = static_cast<unsigned>(stoul(value));
+        else if (key == "--batch") options.batch = stoull(value);
+        else if (key == "--max-pending") options.maxPending = stoull(value);
+        else {
+            cerr << "Unknown option " << key << "\n";
+            return 2;
+        }
+    }
+
+    try {
+        if (!options.binaryFile.empty()) {
+            const mappedGraph mapped(options.binaryFile);
+            return serve(mapped, options);
+        }
+        csrGraph csr;
+        if (!options.graphFile.empty())
+            csr.loadFromFile(options.graphFile);
+        else if (options.generate > 0) {
+            Graph G;
+            G.generateGraph(options.generate, options.seed);
+            csr = csrGraph(G);
+        }
+        else {
+            cerr << "No graph: use --graph, --binary or --generate\n";
+            return 2;
+        }
+        return serve(csr, options);
+    }
+    catch (const exception& e) {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,278 @@
+//---------------------------------------------------------------------------------------------------------
+//  Дерево кратчайших путей от фиксированной вершины, которое поддерживается при изменении рёбер
+//  (в духе алгоритма Ramalingam-Reps).
+//
+//  DynamicDijkstra один раз строит дерево кратчайших путей от source, а затем принимает пакеты
+//  изменений рёбер (вставка, удаление, изменение веса). Изменения применяются к самому графу,
+//  после чего дерево чинится, и пересчитываются только вершины, расстояния которых могли измениться:
+//    - ребро дерева (u, v) удалено или стало тяжелее - расстояния всего поддерева v больше не верны.
+//      Поддерево помечается, метки его вершин сбрасываются, и каждая получает начальную оценку через
+//      входящие рёбра из непомеченных вершин (для этого хранятся списки входящих рёбер);
+//    - ребро (u, v) вставлено или стало легче - v получает оценку через входящие рёбра, если она лучше.
+//  Затем один проход Dijkstra от всех вершин с новыми оценками. Вершины, расстояния которых не
+//  изменились, не трогаются, так что работа пропорциональна изменившейся части дерева.
+//
+//  Граф - basicGraph (Graph.h), изменять его нужно только через applyUpdates этого объекта,
+//  иначе списки входящих рёбер разойдутся с графом. Количество вершин не меняется.
+//---------------------------------------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+#include "Dijkstra.h"
+#include "DAryHeap.h"
+
+template<typename graphType>
+class DynamicDijkstra {
+public:
+	using vertexType = typename graphType::vertex;
+	using size_type = typename graphVertex<vertexType>::size_type;
+	//  Тип длин путей; веса рёбер - edge_weight
+	using weight_type = typename graphVertex<vertexType>::weight_type;
+	using edge_weight = typename vertexType::weight_type;
+	using update_type = typename graphType::update_type;
+
+	DynamicDijkstra(graphType& Graph, size_type Source) : graph(&Graph), start(Source) {
+		if (Source >= Graph.size())
+			throw std::out_of_range("Wrong source node index!");
+
+		for (auto it = Graph.cbegin(); it != Graph.cend(); ++it)
+			nodes.push_back(graphVertex<vertexType>(*it));
+		heap.attach(nodes);
+		affected.assign(nodes.size(), 0);
+
+		incoming.resize(nodes.size());
+		for (auto it = Graph.cbegin(); it != Graph.cend(); ++it)
+			for (auto adjIt = it->cbegin(); adjIt != it->cend(); ++adjIt)
+				incoming[adjIt->dest].push_back(arc{ it->name, adjIt->weight });
+
+		nodes[start].parent = start;
+		nodes[start].weight = 0;
+		nodes[start].state = vertexState::Opened;
+		heap.push(start, 0);
+		run();
+	}
+
+	//  Обёртки вершин указывают на вершины графа, копировать объект незачем
+	DynamicDijkstra(const DynamicDijkstra&) = delete;
+	DynamicDijkstra& operator=(const DynamicDijkstra&) = delete;
+
+	size_type source() const noexcept { return start; }
+
+	bool reached(size_type index) const { return nodes[index].state == vertexState::Finished; }
+
+	//  Расстояние от source (максимальное значение типа - вершина недостижима)
+	weight_type distance(size_type index) const { return nodes[index].weight; }
+
+	//  Путь от source до finishIndex и его стоимость - как у Dijkstra::calcPath
+	std::pair<std::vector<size_type>, weight_type> calcPath(size_type finishIndex) const {
+		if (finishIndex >= nodes.size())
+			throw std::out_of_range("Wrong finish node index!");
+		if (!reached(finishIndex))
+			return make_pair(std::vector<size_type>(), weight_type(0));
+
+		std::vector<size_type> path;
+		size_type nodeIndex(finishIndex);
+		path.push_back(nodeIndex);
+		while (nodeIndex != start) {
+			nodeIndex = nodes[nodeIndex].parent;
+			path.push_back(nodeIndex);
+		}
+		std::reverse(path.begin(), path.end());
+		return make_pair(path, nodes[finishIndex].weight);
+	}
+
+	//  Текущее дерево целиком
+	shortestPathTree<size_type, weight_type> tree() const {
+		shortestPathTree<size_type, weight_type> result;
+		result.start = start;
+		result.weight.reserve(nodes.size());
+		result.parent.reserve(nodes.size());
+		for (const graphVertex<vertexType>& node : nodes) {
+			result.weight.push_back(node.weight);
+			result.parent.push_back(node.parent);
+		}
+		return result;
+	}
+
+	//  Сколько вершин закрыто при последнем пересчёте и сколько из них было в сбрасываемых поддеревьях
+	size_type settledCount() const noexcept { return settled; }
+	size_type affectedCount() const noexcept { return affectedTotal; }
+
+	//  Пакет изменений: применяется к графу по порядку, затем дерево чинится один раз.
+	//  Возвращает количество применённых изменений (как basicGraph::applyUpdates).
+	//  Пакет проверяется целиком до применения: при неверном номере вершины не меняется ничего
+	size_type applyUpdates(const std::vector<update_type>& updates) {
+		for (const update_type& u : updates)
+			if (u.from >= nodes.size() || u.to >= nodes.size())
+				throw std::out_of_range("Wrong vertex index in edge update!");
+
+		roots.clear();
+		candidates.clear();
+		size_type applied = 0;
+
+		for (const update_type& u : updates) {
+			switch (u.kind) {
+			case updateKind::Insert:
+				graph->addEdge(u.from, u.to, u.weight);
+				incoming[u.to].push_back(arc{ u.from, u.weight });
+				candidates.push_back(u.to);
+				++applied;
+				break;
+			case updateKind::Remove:
+				if (!graph->removeEdge(u.from, u.to)) break;
+				removeIncoming(u.from, u.to);
+				markIncreased(u.from, u.to);
+				++applied;
+				break;
+			case updateKind::SetWeight: {
+				auto* e = graph->findEdge(u.from, u.to);
+				if (e == nullptr) break;
+				edge_weight old = e->weight;
+				e->weight = u.weight;
+				findIncoming(u.from, u.to)->weight = u.weight;
+				if (u.weight > old) markIncreased(u.from, u.to);
+				else if (u.weight < old) candidates.push_back(u.to);
+				++applied;
+				break;
+			}
+			}
+		}
+
+		repair();
+		return applied;
+	}
+
+	//  Одиночные изменения - пакет из одного элемента
+	bool insertEdge(size_type from, size_type to, edge_weight w) { return applyUpdates({ update_type{ updateKind::Insert, from, to, w } }) != 0; }
+	bool removeEdge(size_type from, size_type to) { return applyUpdates({ update_type{ updateKind::Remove, from, to, edge_weight() } }) != 0; }
+	bool setEdgeWeight(size_type from, size_type to, edge_weight w) { return applyUpdates({ update_type{ updateKind::SetWeight, from, to, w } }) != 0; }
+
+private:
+	static constexpr size_type npos = std::numeric_limits<size_type>::max();
+	static constexpr weight_type infinity = std::numeric_limits<weight_type>::max();
+
+	//  Входящее ребро: откуда и вес
+	struct arc {
+		size_type from;
+		edge_weight weight;
+	};
+
+	graphType* graph;
+	size_type start;
+
+	std::vector<graphVertex<vertexType>> nodes;
+	fourAryHeap<graphVertex<vertexType>> heap;
+	std::vector<std::vector<arc>> incoming;
+
+	//  Рабочие массивы пересчёта
+	std::vector<char> affected;
+	std::vector<size_type> roots;
+	std::vector<size_type> candidates;
+	std::vector<size_type> subtree;
+
+	size_type settled = 0;
+	size_type affectedTotal = 0;
+
+	//  Первое входящее ребро из from в to - то же ребро, что basicGraph::findEdge (порядок рёбер совпадает)
+	arc* findIncoming(size_type from, size_type to) {
+		for (arc& a : incoming[to])
+			if (a.from == from) return &a;
+		return nullptr;
+	}
+
+	void removeIncoming(size_type from, size_type to) {
+		std::vector<arc>& list = incoming[to];
+		for (auto it = list.begin(); it != list.end(); ++it)
+			if (it->from == from) {
+				list.erase(it);
+				return;
+			}
+	}
+
+	//  Ребро (from, to) удалено или стало тяжелее - если это ребро дерева, то поддерево to надо пересчитать
+	void markIncreased(size_type from, size_type to) {
+		if (to != start && nodes[to].parent == from)
+			roots.push_back(to);
+	}
+
+	//  Лучшая оценка вершины через входящие рёбра из вершин с верными метками
+	void seed(size_type v) {
+		weight_type best = infinity;
+		size_type bestParent = npos;
+		for (const arc& a : incoming[v])
+			if (!affected[a.from] && nodes[a.from].weight != infinity && nodes[a.from].weight + a.weight < best) {
+				best = nodes[a.from].weight + a.weight;
+				bestParent = a.from;
+			}
+		if (best < nodes[v].weight)
+			relax(v, best, bestParent);
+	}
+
+	inline void relax(size_type v, weight_type w, size_type from) {
+		nodes[v].weight = w;
+		nodes[v].parent = from;
+		if (nodes[v].state == vertexState::Opened)
+			heap.decreaseKey(v, w);
+		else {
+			nodes[v].state = vertexState::Opened;
+			heap.push(v, w);
+		}
+	}
+
+	void repair() {
+		//  Поддеревья, подвешенные к удалённым и потяжелевшим рёбрам дерева - обход по рёбрам,
+		//  ведущим к детям (у ребёнка родитель - текущая вершина)
+		subtree.clear();
+		for (size_type root : roots)
+			if (!affected[root]) {
+				affected[root] = 1;
+				subtree.push_back(root);
+			}
+		for (size_type i = 0; i < subtree.size(); ++i) {
+			size_type x = subtree[i];
+			for (auto adjIt = nodes[x].vertex->cbegin(); adjIt != nodes[x].vertex->cend(); ++adjIt) {
+				size_type y = adjIt->dest;
+				if (!affected[y] && y != start && nodes[y].parent == x) {
+					affected[y] = 1;
+					subtree.push_back(y);
+				}
+			}
+		}
+		affectedTotal = subtree.size();
+
+		for (size_type v : subtree) {
+			nodes[v].weight = infinity;
+			nodes[v].parent = npos;
+			nodes[v].state = vertexState::None;
+		}
+		for (size_type v : subtree)
+			seed(v);
+		for (size_type v : candidates)
+			if (!affected[v])
+				seed(v);
+
+		for (size_type v : subtree)
+			affected[v] = 0;
+		run();
+	}
+
+	//  Dijkstra от всех вершин, лежащих в куче. Закрытые ранее вершины с верными метками открываются
+	//  заново только если их расстояние уменьшилось
+	void run() {
+		settled = 0;
+		while (!heap.empty()) {
+			size_type u = heap.top();
+			heap.pop();
+			nodes[u].state = vertexState::Finished;
+			++settled;
+			for (auto adjIt = nodes[u].vertex->cbegin(); adjIt != nodes[u].vertex->cend(); ++adjIt) {
+				weight_type candidate = nodes[u].weight + adjIt->weight;
+				if (candidate < nodes[adjIt->dest].weight)
+					relax(adjIt->dest, candidate, u);
+			}
+		}
+	}
+};
@@ -9,66 +9,127 @@
 #include <initializer_list>
 #include <deque>
 #include <exception>
+#include <limits>
+#include <string>
+#include <ctime>
+#include <cstdlib>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+
+//  Типы индексов и весов - параметры шаблонов. edge, vertex и Graph - прежние варианты на size_t,
+//  compactEdge, compactVertex и compactGraph - 32-битные индексы и веса: ребро занимает 8 байт вместо 16.
+
+//  Тип для накопления длины пути. Сумма весов пути в узком целом типе легко переполняется,
+//  поэтому для целых весов уже 64 бит расстояния считаются в 64-битном типе
+template<typename weightT>
+struct accumulatorFor {
+	using type = typename std::conditional<std::is_integral<weightT>::value && sizeof(weightT) < sizeof(std::uint64_t),
+		typename std::conditional<std::is_signed<weightT>::value, std::int64_t, std::uint64_t>::type,
+		weightT>::type;
+};
 
 //  Ребро
-struct edge {
-	using size_type = size_t;
-	using weight_type = size_t;
+template<typename sizeT = size_t, typename weightT = size_t>
+struct basicEdge {
+	using size_type = sizeT;
+	using weight_type = weightT;
 	//  Куда ведёт ребро
 	size_type dest;
 	//  Вес ребра
 	weight_type weight;
-	edge(size_type Dest, weight_type W) : dest(Dest), weight(W) {}
+	basicEdge(size_type Dest, weight_type W) : dest(Dest), weight(W) {}
+};
+
+//  Изменение ребра для пакетного применения (basicGraph::applyUpdates, DynamicDijkstra::applyUpdates)
+enum class updateKind { Insert, Remove, SetWeight };
+
+template<typename sizeT = size_t, typename weightT = size_t>
+struct edgeUpdate {
+	updateKind kind;
+	sizeT from;
+	sizeT to;
+	//  Для Remove не используется
+	weightT weight;
 };
 
 //  Вершина графа
-class vertex {
+template<typename sizeT = size_t, typename weightT = size_t, typename distanceT = typename accumulatorFor<weightT>::type>
+class basicVertex {
 public:
-	using size_type = edge::size_type;
-	using weight_type = edge::weight_type;
+	using size_type = sizeT;
+	using weight_type = weightT;
+	//  Тип расстояний (длин путей) - его использует Dijkstra для меток вершин
+	using distance_type = distanceT;
 
-	using container_type = std::vector<edge>;
+	using edge_type = basicEdge<sizeT, weightT>;
+	using container_type = std::vector<edge_type>;
 
 	//  Имя - это просто номер/индекс
 	size_type name;
 	//  Список смежных вершин
 	container_type adj;
 
-	explicit vertex(size_type Name) : name(Name) {}
+	explicit basicVertex(size_type Name) : name(Name) {}
 
 	//  Добавление ребра
 	void addEdge(size_type dest, weight_type w) {
-		adj.push_back(edge(dest, w));
+		adj.push_back(edge_type(dest, w));
 	}
 
 	//  Константные итераторы на списки смежных рёбер
-	container_type::const_iterator cbegin() const { return adj.cbegin(); }
-	container_type::const_iterator cend() const { return adj.cend(); }
+	typename container_type::const_iterator cbegin() const { return adj.cbegin(); }
+	typename container_type::const_iterator cend() const { return adj.cend(); }
 };
 
 //  Представление графа
-class Graph {
+template<typename sizeT = size_t, typename weightT = size_t, typename distanceT = typename accumulatorFor<weightT>::type>
+class basicGraph {
 public:
-	using sizetype = vertex::size_type;
-	using weighttype = vertex::weight_type;
+	using vertex = basicVertex<sizeT, weightT, distanceT>;
+	using sizetype = typename vertex::size_type;
+	using weighttype = typename vertex::weight_type;
+	using edge_type = typename vertex::edge_type;
+	using update_type = edgeUpdate<sizetype, weighttype>;
 	//  Количество вершин
-	sizetype grSize;
+	sizetype grSize = 0;
 
 	// Список вершин (со списками смежности)
 	std::vector<vertex> vertices;
 
 
+	basicGraph() = default;
+
+	//  Копия графа с другими типами индексов и весов. Если номер вершины или вес не помещается
+	//  в новый тип, то бросается исключение - молча обрезать веса нельзя
+	template<typename otherGraph>
+	explicit basicGraph(const otherGraph& other) {
+		grSize = checkedCast<sizetype>(other.size());
+		vertices.reserve(grSize);
+		for (auto it = other.cbegin(); it != other.cend(); ++it) {
+			vertices.push_back(vertex(checkedCast<sizetype>(it->name)));
+			for (auto adjIt = it->cbegin(); adjIt != it->cend(); ++adjIt)
+				vertices.back().addEdge(checkedCast<sizetype>(adjIt->dest), checkedCast<weighttype>(adjIt->weight));
+		}
+	}
+
 	sizetype size() const { return grSize; }
 
-	std::vector<vertex>::iterator begin() { return vertices.begin(); }
-	std::vector<vertex>::iterator end() { return vertices.end(); }
+	typename std::vector<vertex>::iterator begin() { return vertices.begin(); }
+	typename std::vector<vertex>::iterator end() { return vertices.end(); }
 
-	std::vector<vertex>::const_iterator cbegin() const { return vertices.cbegin(); }
-	std::vector<vertex>::const_iterator cend() const { return vertices.cend(); }
+	typename std::vector<vertex>::const_iterator cbegin() const { return vertices.cbegin(); }
+	typename std::vector<vertex>::const_iterator cend() const { return vertices.cend(); }
 
 
 	//  Генерация случайного графа
 	void generateGraph(sizetype Size) {
+		generateGraph(Size, static_cast<unsigned int>(time(NULL)));
+	}
+
+	//  То же с заданным зерном - для воспроизводимых запусков (в пределах одной стандартной библиотеки,
+	//  rand() на разных платформах разный; переносимые генераторы - в GraphGenerators.h)
+	void generateGraph(sizetype Size, unsigned int seed) {
 		grSize = Size;
 		vertices.clear();
 		vertices.reserve(grSize);
@@ -76,7 +137,7 @@ public:
 		for (sizetype i = 0; i < grSize; ++i)
 			vertices.push_back(vertex(i));
 
-		srand(static_cast<unsigned int>(time(NULL)));
+		srand(seed);
 		/*std::default_random_engine generator;
 		std::uniform_int_distribution<sizetype> distribution(1, grSize - 1);
 		std::uniform_int_distribution<sizetype> distribution2(1, 100000);*/
@@ -88,8 +149,9 @@ public:
 
 			//  Случайно добавляем рёбра
 			for (size_t i = 0; i < 100; ++i) {
-				sizetype dest = (vert + rand() - RAND_MAX / 2) % grSize;                            //distribution(generator);
-				weighttype w = rand() % 10000; //distribution2(generator);
+				//  Арифметика в size_t - граф с тем же зерном не зависит от ширины индексов
+				sizetype dest = static_cast<sizetype>((size_t(vert) + rand() - RAND_MAX / 2) % grSize);   //distribution(generator);
+				weighttype w = static_cast<weighttype>(rand() % 10000); //distribution2(generator);
 
 				//  Если это петля или такое ребро уже добавляли, то пропуск
 				if (dest == vert || marks[dest] == vert) continue;
@@ -102,6 +164,61 @@ public:
 		}
 	}
 
+	//  Изменение рёбер. Если из from в to ведут несколько рёбер, то меняется первое из них.
+	//  Количество вершин не меняется; итераторы рёбер изменённой вершины после вставки и удаления
+	//  становятся недействительными (адреса самих вершин сохраняются)
+
+	//  Ребро из from в to (nullptr, если его нет)
+	edge_type* findEdge(sizetype from, sizetype to) {
+		checkVertex(from);
+		for (edge_type& e : vertices[from].adj)
+			if (e.dest == to) return &e;
+		return nullptr;
+	}
+
+	void addEdge(sizetype from, sizetype to, weighttype w) {
+		checkVertex(from);
+		checkVertex(to);
+		vertices[from].addEdge(to, w);
+	}
+
+	//  false - такого ребра нет
+	bool removeEdge(sizetype from, sizetype to) {
+		checkVertex(from);
+		auto& adj = vertices[from].adj;
+		for (auto it = adj.begin(); it != adj.end(); ++it)
+			if (it->dest == to) {
+				adj.erase(it);
+				return true;
+			}
+		return false;
+	}
+
+	bool setEdgeWeight(sizetype from, sizetype to, weighttype w) {
+		edge_type* e = findEdge(from, to);
+		if (e == nullptr) return false;
+		e->weight = w;
+		return true;
+	}
+
+	//  Пакет изменений - применяется по порядку. Возвращает количество применённых изменений
+	//  (удаление и изменение веса несуществующего ребра пропускаются). Номера вершин проверяются
+	//  для всего пакета заранее, так что при ошибке граф не остаётся изменённым наполовину
+	sizetype applyUpdates(const std::vector<update_type>& updates) {
+		for (const update_type& u : updates) {
+			checkVertex(u.from);
+			checkVertex(u.to);
+		}
+		sizetype applied = 0;
+		for (const update_type& u : updates)
+			switch (u.kind) {
+			case updateKind::Insert: addEdge(u.from, u.to, u.weight); ++applied; break;
+			case updateKind::Remove: applied += removeEdge(u.from, u.to) ? 1 : 0; break;
+			case updateKind::SetWeight: applied += setEdgeWeight(u.from, u.to, u.weight) ? 1 : 0; break;
+			}
+		return applied;
+	}
+
 	void printGraph() {
 		std::cout << "-----------Graph-----------\n  Size : " << grSize << std::endl;
 
@@ -130,7 +247,7 @@ public:
 
 	void loadFromFile(std::string filename) {
 		std::ifstream in(filename, std::ios_base::in);
-		sizetype Size;
+		sizetype Size = 0;
 		in >> Size;
 		grSize = Size;
 		vertices.clear();
@@ -149,10 +266,37 @@ public:
 		}
 		in.close();
 	}
+
+private:
+	void checkVertex(sizetype index) const {
+		if (index >= grSize)
+			throw std::out_of_range("Wrong vertex index!");
+	}
+
+	template<typename T, typename U>
+	static T checkedCast(U value) {
+		T result = static_cast<T>(value);
+		bool negative = false, negativeResult = false;
+		if constexpr (std::is_signed<U>::value) negative = value < 0;
+		if constexpr (std::is_signed<T>::value) negativeResult = result < 0;
+		if (static_cast<U>(result) != value || negative != negativeResult)
+			throw std::out_of_range("Value does not fit into graph index or weight type");
+		return result;
+	}
 };
 
+using edge = basicEdge<>;
+using vertex = basicVertex<>;
+using Graph = basicGraph<>;
+
+//  Компактная конфигурация: 32-битные номера вершин и веса, расстояния - 64-битные
+using compactEdge = basicEdge<std::uint32_t, std::uint32_t>;
+using compactVertex = basicVertex<std::uint32_t, std::uint32_t>;
+using compactGraph = basicGraph<std::uint32_t, std::uint32_t>;
+
 //  Этот метод необходим для тестирования графа - проверяем доступ извне по константным итераторам
-inline std::ostream& operator<<(std::ostream& out, const Graph& gr) {
+template<typename sizeT, typename weightT, typename distanceT>
+inline std::ostream& operator<<(std::ostream& out, const basicGraph<sizeT, weightT, distanceT>& gr) {
 	out << "Graph  (" << gr.size() << ") nodes \n";
 	for (auto nodeIt = gr.cbegin(); nodeIt != gr.cend(); ++nodeIt) {
 		out << "  Node " << nodeIt->name << '\n';
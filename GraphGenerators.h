@@ -0,0 +1,172 @@
+//---------------------------------------------------------------------------------------------------------
+//  Воспроизводимые генераторы графов разных семейств - для бенчмарков и тестов.
+//
+//  Graph::generateGraph использует rand(), результат которого зависит от стандартной библиотеки.
+//  Здесь используется std::mt19937_64 (его последовательность зафиксирована стандартом) и собственное
+//  преобразование в диапазон (распределения из <random> от реализации зависят), так что одно и то же
+//  зерно даёт один и тот же граф на любой платформе.
+//
+//  Семейства:
+//    - generateRandomGraph - как Graph::generateGraph: у каждой вершины outDegree рёбер в случайные
+//                            вершины, веса равномерно в [0, maxWeight);
+//    - generateGridGraph   - решётка width x height, рёбра к четырём соседям в обе стороны,
+//                            веса - baseWeight с шумом +-noise процентов;
+//    - generateRoadGraph   - "дорожная" планарная сеть: вершины в узлах решётки со случайным сдвигом,
+//                            часть рёбер решётки выброшена, добавлены диагонали одного направления
+//                            (так граф остаётся планарным), каждая 16-я строка и столбец - "магистраль"
+//                            с втрое меньшим весом. Вес ребра пропорционален длине;
+//    - generateRMATGraph   - степенной граф R-MAT (Chakrabarti и др.) на 2^scale вершинах.
+//
+//  Для каждого семейства есть вариант по целевому количеству рёбер (generateFamily) - для бенчмарков.
+//---------------------------------------------------------------------------------------------------------
+
+#pragma once
+#include <random>
+#include <string>
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+#include "Graph.h"
+
+//  Равномерное целое из [0, n) - просто остаток, смещение для n много меньше 2^64 пренебрежимо
+inline unsigned long long uniformIndex(std::mt19937_64& rng, unsigned long long n) { return rng() % n; }
+
+//  Равномерное вещественное из [0, 1)
+inline double uniformReal(std::mt19937_64& rng) { return static_cast<double>(rng() >> 11) * (1.0 / 9007199254740992.0); }
+
+//  Пустой граф на Size вершинах
+inline Graph emptyGraph(Graph::sizetype Size) {
+	Graph G;
+	G.grSize = Size;
+	G.vertices.reserve(Size);
+	for (Graph::sizetype i = 0; i < Size; ++i)
+		G.vertices.push_back(vertex(i));
+	return G;
+}
+
+inline Graph generateRandomGraph(Graph::sizetype Size, Graph::sizetype outDegree = 100,
+	Graph::weighttype maxWeight = 10000, unsigned long long seed = 1) {
+	if (Size < 2)
+		throw std::invalid_argument("Random graph needs at least two vertices");
+	std::mt19937_64 rng(seed);
+	Graph G = emptyGraph(Size);
+
+	//  Отметки рёбер, которые уже добавлены (как в Graph::generateGraph - петли и повторы пропускаются)
+	std::vector<Graph::sizetype> marks(Size, std::numeric_limits<Graph::sizetype>::max());
+	for (Graph::sizetype vert = 0; vert < Size; ++vert) {
+		G.vertices[vert].adj.reserve(outDegree);
+		for (Graph::sizetype i = 0; i < outDegree; ++i) {
+			Graph::sizetype dest = static_cast<Graph::sizetype>(uniformIndex(rng, Size));
+			Graph::weighttype w = static_cast<Graph::weighttype>(uniformIndex(rng, maxWeight));
+			if (dest == vert || marks[dest] == vert) continue;
+			G.vertices[vert].addEdge(dest, w);
+			marks[dest] = vert;
+		}
+	}
+	return G;
+}
+
+inline Graph generateGridGraph(Graph::sizetype width, Graph::sizetype height,
+	Graph::weighttype baseWeight = 100, unsigned noise = 50, unsigned long long seed = 1) {
+	std::mt19937_64 rng(seed);
+	Graph G = emptyGraph(width * height);
+
+	auto noisy = [&]() {
+		double factor = 1.0 + (2.0 * uniformReal(rng) - 1.0) * noise / 100.0;
+		return std::max<Graph::weighttype>(1, static_cast<Graph::weighttype>(std::llround(baseWeight * factor)));
+	};
+	auto link = [&](Graph::sizetype a, Graph::sizetype b) {
+		G.vertices[a].addEdge(b, noisy());
+		G.vertices[b].addEdge(a, noisy());
+	};
+
+	for (Graph::sizetype y = 0; y < height; ++y)
+		for (Graph::sizetype x = 0; x < width; ++x) {
+			Graph::sizetype v = y * width + x;
+			if (x + 1 < width) link(v, v + 1);
+			if (y + 1 < height) link(v, v + width);
+		}
+	return G;
+}
+
+inline Graph generateRoadGraph(Graph::sizetype width, Graph::sizetype height, unsigned long long seed = 1) {
+	std::mt19937_64 rng(seed);
+	Graph G = emptyGraph(width * height);
+
+	//  Координаты вершин - узел решётки со сдвигом до трети шага
+	std::vector<double> px(width * height), py(width * height);
+	for (Graph::sizetype v = 0; v < width * height; ++v) {
+		px[v] = static_cast<double>(v % width) + (uniformReal(rng) - 0.5) * 0.66;
+		py[v] = static_cast<double>(v / width) + (uniformReal(rng) - 0.5) * 0.66;
+	}
+
+	const Graph::sizetype highway = 16;
+	auto link = [&](Graph::sizetype a, Graph::sizetype b, bool fast) {
+		double length = std::hypot(px[a] - px[b], py[a] - py[b]) * 100.0;
+		double speed = fast ? 3.0 : 0.8 + 0.4 * uniformReal(rng);
+		Graph::weighttype w = std::max<Graph::weighttype>(1, static_cast<Graph::weighttype>(std::llround(length / speed)));
+		G.vertices[a].addEdge(b, w);
+		G.vertices[b].addEdge(a, w);
+	};
+
+	for (Graph::sizetype y = 0; y < height; ++y)
+		for (Graph::sizetype x = 0; x < width; ++x) {
+			Graph::sizetype v = y * width + x;
+			//  Магистрали не прерываются, обычные улицы - с вероятностью 85%
+			if (x + 1 < width && (y % highway == 0 || uniformReal(rng) < 0.85))
+				link(v, v + 1, y % highway == 0);
+			if (y + 1 < height && (x % highway == 0 || uniformReal(rng) < 0.85))
+				link(v, v + width, x % highway == 0);
+			if (x + 1 < width && y + 1 < height && uniformReal(rng) < 0.1)
+				link(v, v + width + 1, false);
+		}
+	return G;
+}
+
+inline Graph generateRMATGraph(unsigned scale, Graph::sizetype edgeCount, Graph::weighttype maxWeight = 10000,
+	unsigned long long seed = 1, double a = 0.57, double b = 0.19, double c = 0.19) {
+	std::mt19937_64 rng(seed);
+	Graph G = emptyGraph(Graph::sizetype(1) << scale);
+
+	for (Graph::sizetype i = 0; i < edgeCount; ++i) {
+		//  Спускаемся по квадрантам матрицы смежности - на каждом уровне по одному биту номеров
+		Graph::sizetype from = 0, to = 0;
+		for (unsigned level = 0; level < scale; ++level) {
+			double r = uniformReal(rng);
+			from <<= 1;
+			to <<= 1;
+			if (r < a) {}
+			else if (r < a + b) to |= 1;
+			else if (r < a + b + c) from |= 1;
+			else { from |= 1; to |= 1; }
+		}
+		Graph::weighttype w = 1 + static_cast<Graph::weighttype>(uniformIndex(rng, maxWeight));
+		if (from != to)
+			G.vertices[from].addEdge(to, w);
+	}
+	return G;
+}
+
+//  Семейство по имени и приблизительному количеству рёбер: random, grid, road, rmat
+inline Graph generateFamily(const std::string& family, Graph::sizetype edges, unsigned long long seed = 1) {
+	if (family == "random")
+		return generateRandomGraph(std::max<Graph::sizetype>(edges / 100, 200), 100, 10000, seed);
+	if (family == "grid") {
+		//  У внутренней вершины 4 исходящих ребра
+		Graph::sizetype side = std::max<Graph::sizetype>(2, static_cast<Graph::sizetype>(std::sqrt(edges / 4.0)));
+		return generateGridGraph(side, side, 100, 50, seed);
+	}
+	if (family == "road") {
+		//  В среднем около 3.6 исходящих рёбер на вершину
+		Graph::sizetype side = std::max<Graph::sizetype>(2, static_cast<Graph::sizetype>(std::sqrt(edges / 3.6)));
+		return generateRoadGraph(side, side, seed);
+	}
+	if (family == "rmat") {
+		//  Средняя степень около 16
+		unsigned scale = 1;
+		while ((Graph::sizetype(1) << scale) * 16 < edges)
+			++scale;
+		return generateRMATGraph(scale, edges, 10000, seed);
+	}
+	throw std::invalid_argument("Unknown graph family: " + family);
+}
@@ -0,0 +1,206 @@
+//---------------------------------------------------------------------------------------------------------
+//  Перенумерация вершин графа для локальности обращений к памяти.
+//
+//  Graph::generateGraph соединяет вершину со случайными далёкими номерами, да и реальные графы приходят
+//  в произвольном порядке, поэтому соседние релаксации в calcPath читают случайные элементы nodes и
+//  vertices. После перенумерации соседи по графу получают близкие номера и чаще попадают в одни
+//  строки кэша и страницы. Порядки:
+//    - cuthillMcKeeOrder - обход в ширину (Cuthill-McKee), соседи в порядке возрастания степени,
+//                          по умолчанию перевёрнутый (RCM). Каждая компонента - с вершины наименьшей
+//                          степени;
+//    - degreeOrder       - по убыванию степени: "хабы" степенных графов оказываются рядом;
+//    - partitionOrder    - разбиение на связные куски по blockSize вершин (наращивание обходом в ширину),
+//                          куски идут подряд. Кусок помещается в кэш целиком, а граница между кусками
+//                          меньше, чем у сплошного обхода в ширину.
+//  Граф - basicGraph (Graph.h). Рёбра берутся исходящие, для неориентированных графов (grid, road) это
+//  одно и то же.
+//
+//  vertexPermutation хранит обе перестановки: newId[старый номер] и oldId[новый номер].
+//  reorderGraph строит перенумерованный граф, списки смежности в нём упорядочены по новым номерам.
+//  Reordered<движок> - обёртка над любым движком с calcPath, построенным по перенумерованному графу:
+//  принимает и возвращает исходные номера вершин, так что для вызывающего кода ничего не меняется.
+//
+//  Использование:
+//    auto perm = cuthillMcKeeOrder(G);
+//    const Graph R = reorderGraph(G, perm);
+//    Reordered<Dijkstra<vertex>> dk(perm, R);
+//    auto path = dk.calcPath(start, finish);   //  номера - как в G
+//---------------------------------------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <stdexcept>
+#include <algorithm>
+
+template<typename sizeT = size_t>
+struct vertexPermutation {
+	using size_type = sizeT;
+
+	//  newId[старый номер] - новый номер, oldId[новый номер] - старый номер
+	std::vector<size_type> newId;
+	std::vector<size_type> oldId;
+
+	size_type size() const noexcept { return static_cast<size_type>(oldId.size()); }
+
+	//  Перестановка по последовательности старых номеров в новом порядке
+	static vertexPermutation fromOrder(std::vector<size_type> order) {
+		vertexPermutation result;
+		result.newId.assign(order.size(), static_cast<size_type>(order.size()));
+		for (size_type i = 0; i < order.size(); ++i) {
+			if (order[i] >= order.size() || result.newId[order[i]] != order.size())
+				throw std::invalid_argument("Vertex order is not a permutation");
+			result.newId[order[i]] = i;
+		}
+		result.oldId = std::move(order);
+		return result;
+	}
+};
+
+namespace reorderDetail {
+	template<typename graphType>
+	std::vector<typename graphType::sizetype> degrees(const graphType& G) {
+		std::vector<typename graphType::sizetype> result;
+		result.reserve(G.size());
+		for (auto it = G.cbegin(); it != G.cend(); ++it)
+			result.push_back(static_cast<typename graphType::sizetype>(std::distance(it->cbegin(), it->cend())));
+		return result;
+	}
+
+	//  Номера вершин по возрастанию степени (при равенстве - по номеру)
+	template<typename sizeT>
+	std::vector<sizeT> byDegree(const std::vector<sizeT>& degree) {
+		std::vector<sizeT> order(degree.size());
+		for (sizeT i = 0; i < order.size(); ++i)
+			order[i] = i;
+		std::stable_sort(order.begin(), order.end(), [&degree](sizeT a, sizeT b) { return degree[a] < degree[b]; });
+		return order;
+	}
+}
+
+template<typename graphType>
+vertexPermutation<typename graphType::sizetype> cuthillMcKeeOrder(const graphType& G, bool reverse = true) {
+	using size_type = typename graphType::sizetype;
+	const auto degree = reorderDetail::degrees(G);
+	const auto starts = reorderDetail::byDegree(degree);
+
+	std::vector<size_type> order;
+	order.reserve(G.size());
+	std::vector<char> visited(G.size(), 0);
+	std::vector<size_type> neighbours;
+
+	for (size_type root : starts) {
+		if (visited[root]) continue;
+		visited[root] = 1;
+		//  order сам служит очередью обхода
+		size_type head = order.size();
+		order.push_back(root);
+		for (; head < order.size(); ++head) {
+			const auto& v = G.vertices[order[head]];
+			neighbours.clear();
+			for (auto adjIt = v.cbegin(); adjIt != v.cend(); ++adjIt)
+				if (!visited[adjIt->dest]) {
+					visited[adjIt->dest] = 1;
+					neighbours.push_back(adjIt->dest);
+				}
+			std::stable_sort(neighbours.begin(), neighbours.end(), [&degree](size_type a, size_type b) { return degree[a] < degree[b]; });
+			order.insert(order.end(), neighbours.begin(), neighbours.end());
+		}
+	}
+	if (reverse)
+		std::reverse(order.begin(), order.end());
+	return vertexPermutation<size_type>::fromOrder(std::move(order));
+}
+
+template<typename graphType>
+vertexPermutation<typename graphType::sizetype> degreeOrder(const graphType& G) {
+	auto order = reorderDetail::byDegree(reorderDetail::degrees(G));
+	std::reverse(order.begin(), order.end());
+	return vertexPermutation<typename graphType::sizetype>::fromOrder(std::move(order));
+}
+
+template<typename graphType>
+vertexPermutation<typename graphType::sizetype> partitionOrder(const graphType& G,
+	typename graphType::sizetype blockSize = 1024) {
+	using size_type = typename graphType::sizetype;
+	if (blockSize == 0)
+		throw std::invalid_argument("Partition block size must be positive");
+
+	std::vector<size_type> order;
+	order.reserve(G.size());
+	//  Вершины, не поместившиеся в кусок, достанутся следующим кускам
+	std::vector<char> assigned(G.size(), 0);
+
+	for (size_type seed = 0; seed < G.size(); ++seed) {
+		if (assigned[seed]) continue;
+		const size_type blockStart = order.size();
+		assigned[seed] = 1;
+		order.push_back(seed);
+		for (size_type head = blockStart; head < order.size() && order.size() - blockStart < blockSize; ++head) {
+			const auto& v = G.vertices[order[head]];
+			for (auto adjIt = v.cbegin(); adjIt != v.cend() && order.size() - blockStart < blockSize; ++adjIt)
+				if (!assigned[adjIt->dest]) {
+					assigned[adjIt->dest] = 1;
+					order.push_back(adjIt->dest);
+				}
+		}
+	}
+	return vertexPermutation<size_type>::fromOrder(std::move(order));
+}
+
+//  Перенумерованный граф: вершина newId[v] - бывшая v, рёбра отсортированы по новым номерам
+template<typename graphType>
+graphType reorderGraph(const graphType& G, const vertexPermutation<typename graphType::sizetype>& perm) {
+	using size_type = typename graphType::sizetype;
+	if (perm.size() != G.size())
+		throw std::invalid_argument("Permutation size does not match the graph");
+
+	graphType result;
+	result.grSize = G.size();
+	result.vertices.reserve(G.size());
+	for (size_type i = 0; i < G.size(); ++i) {
+		const auto& old = G.vertices[perm.oldId[i]];
+		result.vertices.push_back(typename graphType::vertex(i));
+		auto& adj = result.vertices.back().adj;
+		adj.reserve(old.adj.size());
+		for (const auto& e : old.adj)
+			adj.push_back(typename graphType::edge_type(perm.newId[e.dest], e.weight));
+		std::sort(adj.begin(), adj.end(), [](const auto& a, const auto& b) { return a.dest < b.dest; });
+	}
+	return result;
+}
+
+//  Движок, построенный по перенумерованному графу, с исходными номерами вершин снаружи
+template<typename engineType, typename sizeT = size_t>
+class Reordered {
+public:
+	using size_type = sizeT;
+
+	//  Остальные аргументы передаются конструктору движка (обычно - перенумерованный граф).
+	//  Перестановка хранится в самом объекте (её можно передать через std::move), так что
+	//  временный объект перестановки не оставит висячей ссылки
+	template<typename... Args>
+	explicit Reordered(vertexPermutation<sizeT> Perm, Args&&... args) :
+		perm(std::move(Perm)), engine(std::forward<Args>(args)...) {}
+
+	auto calcPath(size_type startIndex, size_type finishIndex) {
+		if (startIndex >= perm.size())
+			throw std::out_of_range("Wrong start node index!");
+		if (finishIndex >= perm.size())
+			throw std::out_of_range("Wrong finish node index!");
+		auto result = engine.calcPath(perm.newId[startIndex], perm.newId[finishIndex]);
+		for (auto& x : result.first)
+			x = perm.oldId[x];
+		return result;
+	}
+
+	auto settledCount() const { return engine.settledCount(); }
+
+	engineType& inner() noexcept { return engine; }
+	const vertexPermutation<sizeT>& permutation() const noexcept { return perm; }
+
+private:
+	vertexPermutation<sizeT> perm;
+	engineType engine;
+};
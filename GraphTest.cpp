@@ -1,10 +1,37 @@
 #include <iostream>
 #include <ctime>
+#include <cstdio>
+#include <thread>
+#include <tuple>
+#include <cstddef>
 #include "Graph.h"
 #include "Dijkstra.h"
+#include "CSRGraph.h"
+#include "DAryHeap.h"
+#include "MonotoneQueues.h"
+#include "BiDijkstra.h"
+#include "AStar.h"
+#include "BinaryGraph.h"
+#include "BatchDijkstra.h"
+#include "DeltaStepping.h"
+#include "DynamicDijkstra.h"
+#include "GraphReordering.h"
+#include "SimdDijkstra.h"
+#include "SPTCache.h"
+#include "ContractionHierarchies.h"
+#include "GraphGenerators.h"
+#include "QueryServer.h"
 
 using namespace std;
 
+//  Маленький граф из списка рёбер (откуда, куда, вес) - для проверок на заданных примерах
+static Graph smallGraph(vertex::size_type size, const vector<tuple<vertex::size_type, vertex::size_type, vertex::weight_type>>& edges) {
+    Graph G = emptyGraph(size);
+    for (const auto& e : edges)
+        G.addEdge(get<0>(e), get<1>(e), get<2>(e));
+    return G;
+}
+
 int main(int argc, char* argv[])
 {
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
@@ -13,10 +40,13 @@ int main(int argc, char* argv[])
 
     const Graph G = [argc, argv]{
         Graph G;
-        if (argc == 1) {
-            G.loadFromFile("Dijkstra.txt");
+        const string filename = argc == 1 ? "Dijkstra.txt" : argv[1];
+        //  Файл с тестовым графом большой и в репозиторий не входит - если его нет, генерируем случайный граф
+        if (ifstream(filename)) {
+            G.loadFromFile(filename);
         } else {
-            G.loadFromFile(argv[1]);
+            cout << "File " << filename << " not found, generating random graph\n";
+            G.generateGraph(10000, 1);
         }
         return G;
     }();
@@ -38,6 +68,490 @@ int main(int argc, char* argv[])
     cout << "\nДлина пути из " << startNode << " в " << finishNode << " равна " << v.second << "\n";
     cout << "Time: " << double(finish - start) / CLOCKS_PER_SEC << " seconds\n";
 
+    //  Тот же запрос на CSR-представлении графа и с 4-арной кучей - стоимость пути должна совпасть
+    const csrGraph csr(G);
+    start = clock();
+    Dijkstra<csrVertex, fourAryHeap> csrDk(csr);
+    auto csrV = csrDk.calcPath(startNode, finishNode);
+    finish = clock();
+    cout << "CSR time: " << double(finish - start) / CLOCKS_PER_SEC << " seconds\n";
+    if (csrV.second != v.second) {
+        cout << "CSR path length mismatch: " << csrV.second << "\n";
+        return 1;
+    }
+
+    //  Файл с ребром в несуществующую вершину (3 при двух вершинах) не загружается
+    {
+        ofstream("GraphTest.txt") << "2\n0 1 3 5\n1 1 0 2\n";
+        bool thrown = false;
+        try {
+            csrGraph broken;
+            broken.loadFromFile("GraphTest.txt");
+        }
+        catch (const out_of_range&) {
+            thrown = true;
+        }
+        remove("GraphTest.txt");
+        if (!thrown) {
+            cout << "CSR file with a wrong edge destination was loaded\n";
+            return 1;
+        }
+    }
+
+    //  Векторизованная релаксация - все наборы инструкций, доступные на этой машине, плюс скалярный вариант
+    for (simdLevel level : { simdLevel::Scalar, simdLevel::AVX2, simdLevel::AVX512 }) {
+        SimdDijkstra simdDk(csr, level);
+        if (simdDk.level() != level) continue;
+        start = clock();
+        auto simdV = simdDk.calcPath(startNode, finishNode);
+        finish = clock();
+        cout << "SIMD (" << simdLevelName(level) << ") time: " << double(finish - start) / CLOCKS_PER_SEC << " seconds\n";
+        if (simdV.second != v.second || simdDk.settledCount() != csrDk.settledCount() || simdV.first.front() != startNode || simdV.first.back() != finishNode
+            || simdDk.calcPath(finishNode, startNode).second != dk.calcPath(finishNode, startNode).second) {
+            cout << "SIMD path length mismatch (" << simdLevelName(level) << "): " << simdV.second << "\n";
+            return 1;
+        }
+    }
+
+    //  Статистика запроса - тот же поиск с 4-арной кучей, плюс сумма по двум запросам через функцию обратного вызова
+    {
+        Dijkstra<csrVertex, fourAryHeap, searchStats> statDk(csr);
+        searchStats total;
+        statDk.setStatsCallback([&total](const searchStats& s) { total += s; });
+        auto statV = statDk.calcPath(startNode, finishNode);
+        cout << "Search stats: " << statDk.stats() << "\n";
+        statDk.calcPath(finishNode, startNode);
+        const searchStats& s = statDk.stats();
+        if (statV.second != v.second || total.queries != 2 || s.pops != s.verticesSettled
+            || s.pushes < s.pops || total.edgesRelaxed < s.edgesRelaxed) {
+            cout << "Search stats mismatch\n";
+            return 1;
+        }
+    }
+
+    //  Компактный граф: 32-битные номера вершин, 16-битные веса, длины путей - в 64 битах
+    {
+        const basicGraph<uint32_t, uint16_t> compact(G);
+        Dijkstra<basicVertex<uint32_t, uint16_t>, fourAryHeap> compactDk(compact);
+        start = clock();
+        auto compactV = compactDk.calcPath(startNode, finishNode);
+        finish = clock();
+        cout << "Compact graph time: " << double(finish - start) / CLOCKS_PER_SEC << " seconds\n";
+        if (compactV.second != v.second) {
+            cout << "Compact graph path length mismatch: " << compactV.second << "\n";
+            return 1;
+        }
+    }
+
+    //  Монотонная очередь для целых весов (корзины Дейла или поразрядная куча)
+    Dijkstra<vertex, autoQueue> autoDk(G);
+    start = clock();
+    auto autoV = autoDk.calcPath(startNode, finishNode);
+    finish = clock();
+    cout << "Monotone queue time: " << double(finish - start) / CLOCKS_PER_SEC << " seconds\n";
+    if (autoV.second != v.second) {
+        cout << "Monotone queue path length mismatch: " << autoV.second << "\n";
+        return 1;
+    }
+
+    //  Корзины Дейла не берутся за веса от dialQueue::maxBuckets - вместо огромного кольца length_error
+    {
+        const vertex::weight_type limit = static_cast<vertex::weight_type>(dialQueue<graphVertex<vertex>>::maxBuckets);
+        const Graph light = smallGraph(3, { { 0, 1, limit - 1 }, { 1, 2, 5 } });
+        const Graph heavy = smallGraph(3, { { 0, 1, limit }, { 1, 2, 5 } });
+        Dijkstra<vertex, dialQueue> below(light);
+        bool thrown = false;
+        try {
+            Dijkstra<vertex, dialQueue> above(heavy);
+        }
+        catch (const length_error&) {
+            thrown = true;
+        }
+        if (below.calcPath(0, 2).second != limit + 4 || !thrown) {
+            cout << "Dial bucket limit is not enforced\n";
+            return 1;
+        }
+    }
+
+    //  И двунаправленный поиск
+    BiDijkstra<vertex> bdk(G);
+    start = clock();
+    auto biV = bdk.calcPath(startNode, finishNode);
+    finish = clock();
+    cout << "Bidirectional time: " << double(finish - start) / CLOCKS_PER_SEC << " seconds, settled " << bdk.settledCount() << "\n";
+    if (biV.second != v.second) {
+        cout << "Bidirectional path length mismatch: " << biV.second << "\n";
+        return 1;
+    }
+
+    //  ALT: опорные вершины строятся один раз, потом A* с эвристикой по ним
+    const landmarks lm(G, 8);
+    AStar<vertex, altHeuristic> alt(G, altHeuristic(lm));
+    start = clock();
+    auto altV = alt.calcPath(startNode, finishNode);
+    finish = clock();
+    cout << "ALT time: " << double(finish - start) / CLOCKS_PER_SEC << " seconds, settled " << alt.settledCount() << "\n";
+    if (altV.second != v.second) {
+        cout << "ALT path length mismatch: " << altV.second << "\n";
+        return 1;
+    }
+
+    //  Параллельный delta-stepping - с шириной корзины по умолчанию и с очень узкой и очень широкой корзинами
+    for (vertex::weight_type delta : { vertex::weight_type(0), vertex::weight_type(1), vertex::weight_type(1000000) }) {
+        DeltaStepping<vertex> ds(G, 4, delta);
+        start = clock();
+        auto dsV = ds.calcPath(startNode, finishNode);
+        finish = clock();
+        cout << "Delta-stepping (delta " << ds.delta() << ", " << ds.threads() << " threads) CPU time: "
+            << double(finish - start) / CLOCKS_PER_SEC << " seconds\n";
+        if (dsV.second != v.second || dsV.first.front() != startNode || dsV.first.back() != finishNode) {
+            cout << "Delta-stepping path length mismatch: " << dsV.second << "\n";
+            return 1;
+        }
+    }
+
+    //  Контрактные иерархии - на разреженных графах, для которых они и предназначены: дорожная сеть
+    //  и ориентированный R-MAT. Запросы по иерархии и по иерархии, сохранённой в файл и загруженной
+    //  обратно, должны совпасть с обычным поиском - и по стоимости, и по рёбрам раскрытого пути
+    for (const Graph& sparse : { generateRoadGraph(40, 40, 3), generateRMATGraph(10, 6000, 10000, 5) }) {
+        start = clock();
+        const contractionHierarchy ch(sparse, 2);
+        finish = clock();
+        cout << "CH preprocessing (" << sparse.size() << " vertices) CPU time: " << double(finish - start) / CLOCKS_PER_SEC
+            << " seconds, shortcuts " << ch.shortcutCount() << "\n";
+        ch.saveToFile("GraphTest.ch");
+        contractionHierarchy loaded;
+        loaded.loadFromFile("GraphTest.ch");
+        remove("GraphTest.ch");
+
+        Dijkstra<vertex> plain(sparse);
+        CHDijkstra chDk(ch), loadedDk(loaded);
+        std::mt19937_64 rng(11);
+        for (int i = 0; i < 200; ++i) {
+            const vertex::size_type from = static_cast<vertex::size_type>(uniformIndex(rng, sparse.size()));
+            const vertex::size_type to = static_cast<vertex::size_type>(uniformIndex(rng, sparse.size()));
+            auto expected = plain.calcPath(from, to);
+            auto chV = chDk.calcPath(from, to);
+            bool valid = chV.second == expected.second && chV.first.empty() == expected.first.empty()
+                && loadedDk.calcPath(from, to) == chV;
+            //  Длина пути по исходным рёбрам (из кратных рёбер - самое короткое)
+            vertex::weight_type length = 0;
+            for (size_t j = 0; valid && j + 1 < chV.first.size(); ++j) {
+                auto best = numeric_limits<vertex::weight_type>::max();
+                for (const edge& e : sparse.vertices[chV.first[j]].adj)
+                    if (e.dest == chV.first[j + 1])
+                        best = min(best, e.weight);
+                valid = best != numeric_limits<vertex::weight_type>::max();
+                length += best;
+            }
+            if (!valid || (!chV.first.empty() && (chV.first.front() != from || chV.first.back() != to || length != chV.second))) {
+                cout << "CH path mismatch from " << from << " to " << to << ": " << chV.second << " vs " << expected.second << "\n";
+                return 1;
+            }
+        }
+    }
+
+    //  Испорченная иерархия не загружается: огромное число вершин, ребро в несуществующую вершину и
+    //  первое смещение не с нуля. Файл: 4 байта подписи, число вершин, сокращений, ранги, затем граф
+    //  вверх - число рёбер, смещения и рёбра по три значения
+    {
+        const Graph grid = generateRoadGraph(5, 5, 3);
+        const uint64_t vertices = grid.size();
+        const uint64_t upStart = 4 + 16 + 8 * vertices;
+        const uint64_t huge = ~uint64_t(0) / 4, badDest = vertices, badOffset = 1;
+        const pair<uint64_t, uint64_t> patches[] = {
+            { 4, huge }, { upStart + 8 + 8 * (vertices + 1), badDest }, { upStart + 8, badOffset } };
+        for (const auto& patch : patches) {
+            contractionHierarchy(grid, 1).saveToFile("GraphTest.ch");
+            fstream file("GraphTest.ch", ios_base::in | ios_base::out | ios_base::binary);
+            file.seekp(static_cast<streamoff>(patch.first));
+            file.write(reinterpret_cast<const char*>(&patch.second), sizeof(patch.second));
+            file.close();
+            bool thrown = false;
+            try {
+                contractionHierarchy broken;
+                broken.loadFromFile("GraphTest.ch");
+            }
+            catch (const runtime_error&) {
+                thrown = true;
+            }
+            if (!thrown) {
+                cout << "Corrupted contraction hierarchy was loaded\n";
+                return 1;
+            }
+        }
+        remove("GraphTest.ch");
+    }
+
+    //  Двоичный формат: запись и загрузка через отображение в память, поиск прямо по файлу
+    saveBinaryGraph(G, "GraphTest.bin");
+    {
+        start = clock();
+        const mappedGraph mapped("GraphTest.bin");
+        finish = clock();
+        cout << "Binary map time: " << double(finish - start) / CLOCKS_PER_SEC << " seconds\n";
+        Dijkstra<csrVertex> mappedDk(mapped);
+        auto mappedV = mappedDk.calcPath(startNode, finishNode);
+        if (mappedV.second != v.second) {
+            cout << "Mapped graph path length mismatch: " << mappedV.second << "\n";
+            return 1;
+        }
+    }
+    //  Испорченные файлы отвергаются при загрузке: ребро в несуществующую вершину и огромное число рёбер в заголовке
+    {
+        binaryGraphHeader header;
+        ifstream("GraphTest.bin", ios_base::binary).read(reinterpret_cast<char*>(&header), sizeof(header));
+        const csrView::size_type badDest = G.size();
+        const uint64_t badCount = ~uint64_t(0) / 4;
+        const pair<uint64_t, string> patches[] = {
+            { header.destsPos, string(reinterpret_cast<const char*>(&badDest), sizeof(badDest)) },
+            { offsetof(binaryGraphHeader, edgeCount), string(reinterpret_cast<const char*>(&badCount), sizeof(badCount)) } };
+        for (const auto& patch : patches) {
+            saveBinaryGraph(G, "GraphTest.bin");
+            fstream file("GraphTest.bin", ios_base::in | ios_base::out | ios_base::binary);
+            file.seekp(static_cast<streamoff>(patch.first));
+            file.write(patch.second.data(), static_cast<streamsize>(patch.second.size()));
+            file.close();
+            bool thrown = false;
+            try {
+                const mappedGraph broken("GraphTest.bin");
+            }
+            catch (const runtime_error&) {
+                thrown = true;
+            }
+            if (!thrown) {
+                cout << "Corrupted binary graph was loaded\n";
+                return 1;
+            }
+        }
+    }
+    remove("GraphTest.bin");
+
+    //  Пакет запросов в несколько потоков - стоимости должны совпасть с последовательными запросами
+    {
+        using batchType = BatchDijkstra<vertex, fourAryHeap>;
+        vector<batchType::query> queries;
+        for (vertex::size_type i = 0; i < 64; ++i)
+            queries.push_back(make_pair(i * 7919 % G.size(), (i * 104729 + 17) % G.size()));
+        batchType batch(G, 4);
+        start = clock();
+        auto results = batch.calcPaths(queries);
+        finish = clock();
+        cout << "Batch of " << queries.size() << " queries on " << batch.threads() << " threads, CPU time: "
+            << double(finish - start) / CLOCKS_PER_SEC << " seconds\n";
+        for (size_t i = 0; i < queries.size(); ++i)
+            if (results[i].second != dk.calcPath(queries[i].first, queries[i].second).second) {
+                cout << "Batch path length mismatch in query " << i << "\n";
+                return 1;
+            }
+    }
+
+    //  Конвейер сервера запросов: пачки по 8 запросов на 4 потоках, не больше 16 неотданных ответов.
+    //  Ответы (включая ошибку и stats) должны прийти ровно в порядке запросов, хотя считаются вперемешку
+    {
+        using pipelineType = queryPipeline<Graph, Dijkstra<vertex, fourAryHeap>>;
+        pipelineType pipeline(G, 4, 8, 16);
+        vector<pipelineType::request> requests;
+        for (vertex::size_type i = 0; i < 64; ++i) {
+            pipelineType::request q;
+            q.source = i * 7919 % G.size();
+            q.target = (i * 104729 + 17) % G.size();
+            if (i == 20) q.type = pipelineType::request::kind::Malformed;
+            if (i == 40) q.type = pipelineType::request::kind::Stats;
+            requests.push_back(q);
+        }
+        vector<pipelineType::response> responses;
+        start = clock();
+        {
+            queryStream<Graph, Dijkstra<vertex, fourAryHeap>> stream(pipeline, [&responses](const pipelineType::response& r) {
+                responses.push_back(r);
+            });
+            for (const auto& q : requests)
+                stream.submit(q);
+        }
+        finish = clock();
+        cout << "Query pipeline of " << requests.size() << " requests on " << pipeline.threads() << " threads, CPU time: "
+            << double(finish - start) / CLOCKS_PER_SEC << " seconds\n";
+        bool valid = responses.size() == requests.size();
+        for (size_t i = 0; valid && i < requests.size(); ++i) {
+            if (requests[i].type == pipelineType::request::kind::Malformed)
+                valid = !responses[i].ok;
+            else if (requests[i].type == pipelineType::request::kind::Stats)
+                valid = responses[i].ok && responses[i].text.compare(0, 9, "vertices ") == 0;
+            else {
+                auto expected = dk.calcPath(requests[i].source, requests[i].target);
+                valid = responses[i].ok && responses[i].cost == expected.second && responses[i].path == expected.first;
+            }
+        }
+        if (!valid) {
+            cout << "Query pipeline order mismatch\n";
+            return 1;
+        }
+    }
+
+    //  Один ко всем и один ко многим - расстояния должны совпасть с запросами "из точки в точку"
+    {
+        auto tree = dk.calcTree(startNode);
+        if (tree.weight[finishNode] != v.second || tree.path(finishNode).size() != v.first.size()) {
+            cout << "Shortest path tree mismatch: " << tree.weight[finishNode] << "\n";
+            return 1;
+        }
+        const vector<vertex::size_type> sources = { 0, startNode, 42 % G.size() };
+        const vector<vertex::size_type> targets = { finishNode, 0, 77 % G.size(), finishNode };
+        auto table = BatchDijkstra<vertex>(G, 2).distanceTable(sources, targets);
+        for (size_t i = 0; i < sources.size(); ++i)
+            for (size_t j = 0; j < targets.size(); ++j) {
+                auto pointToPoint = dk.calcPath(sources[i], targets[j]);
+                auto expected = pointToPoint.first.empty() ? numeric_limits<vertex::weight_type>::max() : pointToPoint.second;
+                if (table[i * targets.size() + j] != expected) {
+                    cout << "Distance table mismatch at " << i << ", " << j << "\n";
+                    return 1;
+                }
+            }
+
+        //  Запрос с неверной стартовой вершиной не должен оставлять отметок целей для следующих запросов
+        bool thrown = false;
+        try {
+            dk.calcDistances(G.size(), { finishNode });
+        }
+        catch (const out_of_range&) {
+            thrown = true;
+        }
+        auto toZero = dk.calcPath(startNode, 0);
+        auto afterError = dk.calcDistances(startNode, { 0 });
+        if (!thrown || afterError[0] != (toZero.first.empty() ? numeric_limits<vertex::weight_type>::max() : toZero.second)
+            || !dk.calcDistances(startNode, {}).empty()) {
+            cout << "Distances after a failed query mismatch\n";
+            return 1;
+        }
+    }
+
+    //  Кэш начал поиска: запросы из нескольких стартовых вершин в несколько потоков с общим кэшем.
+    //  Ответы из кэша и продолженные поиски должны совпасть с обычными запросами
+    {
+        sptCache<vertex::size_type, vertex::weight_type> cache(4 << 20);
+        const vector<vertex::size_type> sources = { startNode, 0, 42 % G.size() };
+        vector<vector<pair<vertex::size_type, vertex::size_type>>> work(4);
+        for (vertex::size_type i = 0; i < 48; ++i)
+            work[i % work.size()].push_back(make_pair(sources[i % sources.size()], (i * 7919 + 3) % G.size()));
+        vector<char> failed(work.size(), 0);
+        vector<thread> workers;
+        start = clock();
+        for (size_t t = 0; t < work.size(); ++t)
+            workers.emplace_back([&, t] {
+                CachedDijkstra<vertex> cached(G, cache);
+                Dijkstra<vertex> plain(G);
+                for (const auto& q : work[t]) {
+                    auto cachedV = cached.calcPath(q.first, q.second);
+                    auto plainV = plain.calcPath(q.first, q.second);
+                    if (cachedV.second != plainV.second || cachedV.first.size() != plainV.first.size()
+                        || (!cachedV.first.empty() && (cachedV.first.front() != q.first || cachedV.first.back() != q.second)))
+                        failed[t] = 1;
+                }
+            });
+        for (thread& w : workers)
+            w.join();
+        finish = clock();
+        const cacheCounters counters = cache.counters();
+        cout << "Search prefix cache CPU time: " << double(finish - start) / CLOCKS_PER_SEC << " seconds, " << counters << "\n";
+        if (find(failed.begin(), failed.end(), 1) != failed.end() || counters.hits + counters.resumes == 0
+            || counters.hits + counters.resumes + counters.misses != 48 || counters.bytes > cache.budgetBytes()) {
+            cout << "Search prefix cache mismatch\n";
+            return 1;
+        }
+
+        //  Поиск, остановленный на вершине 1, продолжается через её рёбра: путь 0-1-2 дешевле ребра 0-2
+        const Graph tiny = smallGraph(3, { { 0, 1, 1 }, { 1, 2, 1 }, { 0, 2, 100 } });
+        sptCache<vertex::size_type, vertex::weight_type> tinyCache(1 << 20);
+        CachedDijkstra<vertex> tinyCached(tiny, tinyCache);
+        tinyCached.calcPath(0, 1);
+        if (tinyCached.calcPath(0, 2).second != 2) {
+            cout << "Search prefix cache resume mismatch\n";
+            return 1;
+        }
+
+        //  Продолжение с монотонной очередью: граница {2 (10), 3 (3)} загружается не по порядку обхода
+        const Graph fan = smallGraph(4, { { 0, 1, 1 }, { 0, 2, 10 }, { 0, 3, 3 }, { 3, 2, 1 } });
+        sptCache<vertex::size_type, vertex::weight_type> fanCache(1 << 20);
+        CachedDijkstra<vertex, autoQueue> fanCached(fan, fanCache);
+        fanCached.calcPath(0, 1);
+        if (fanCached.calcPath(0, 2).second != 4) {
+            cout << "Search prefix cache monotone queue mismatch\n";
+            return 1;
+        }
+    }
+
+    //  Перенумерация вершин для локальности: снаружи номера прежние, путь - по рёбрам исходного графа
+    for (const char* orderName : { "rcm", "degree", "partition" }) {
+        start = clock();
+        const auto perm = string(orderName) == "rcm" ? cuthillMcKeeOrder(G) : string(orderName) == "degree" ? degreeOrder(G) : partitionOrder(G);
+        const Graph reordered = reorderGraph(G, perm);
+        finish = clock();
+        Reordered<Dijkstra<vertex>> reorderedDk(perm, reordered);
+        auto reorderedV = reorderedDk.calcPath(startNode, finishNode);
+        cout << "Reordering (" << orderName << ") time: " << double(finish - start) / CLOCKS_PER_SEC << " seconds\n";
+        bool valid = reorderedV.second == v.second && reorderedV.first.front() == startNode && reorderedV.first.back() == finishNode;
+        for (size_t i = 0; valid && i + 1 < reorderedV.first.size(); ++i) {
+            const auto& adj = G.vertices[reorderedV.first[i]].adj;
+            valid = any_of(adj.begin(), adj.end(), [&](const edge& e) { return e.dest == reorderedV.first[i + 1]; });
+        }
+        if (!valid) {
+            cout << "Reordered graph path mismatch (" << orderName << "): " << reorderedV.second << "\n";
+            return 1;
+        }
+    }
+
+    //  Изменения рёбер: дерево от startNode чинится после каждого пакета и должно совпасть с построенным заново.
+    //  В пакете - удаления и утяжеления рёбер дерева, вставки и облегчения
+    {
+        Graph dynG(G);
+        DynamicDijkstra<Graph> dyn(dynG, startNode);
+        for (vertex::size_type round = 0; round < 3; ++round) {
+            const auto parent = dyn.tree().parent;
+            vector<Graph::update_type> updates;
+            for (vertex::size_type i = 0; i < 50; ++i) {
+                const vertex::size_type x = (i * 7919 + round * 104729 + 1) % G.size();
+                const vertex::size_type y = (i * 15485863 + round * 31) % G.size();
+                if (x != startNode && parent[x] < G.size())
+                    updates.push_back({ i % 2 ? updateKind::Remove : updateKind::SetWeight, parent[x], x, 100000 });
+                updates.push_back({ updateKind::Insert, x, y, (i * 37) % 5000 });
+                if (!dynG.vertices[y].adj.empty())
+                    updates.push_back({ updateKind::SetWeight, y, dynG.vertices[y].adj.front().dest, 1 });
+            }
+            start = clock();
+            dyn.applyUpdates(updates);
+            finish = clock();
+            cout << "Dynamic update of " << updates.size() << " edges: " << double(finish - start) / CLOCKS_PER_SEC
+                << " seconds, affected " << dyn.affectedCount() << ", settled " << dyn.settledCount() << "\n";
+
+            auto fresh = Dijkstra<vertex>(dynG).calcTree(startNode);
+            for (vertex::size_type i = 0; i < G.size(); ++i)
+                if (dyn.distance(i) != fresh.weight[i]) {
+                    cout << "Dynamic shortest path tree mismatch at " << i << "\n";
+                    return 1;
+                }
+            if (dyn.calcPath(finishNode).second != fresh.weight[finishNode]) {
+                cout << "Dynamic path length mismatch\n";
+                return 1;
+            }
+        }
+
+        //  Пакет с неверной вершиной отклоняется целиком - первое (верное) изменение тоже не применяется
+        const size_t degree = dynG.vertices[startNode].adj.size();
+        const auto distance = dyn.distance(finishNode);
+        bool thrown = false;
+        try {
+            dyn.applyUpdates({ { updateKind::Insert, startNode, finishNode, 0 }, { updateKind::Insert, startNode, G.size(), 1 } });
+        }
+        catch (const out_of_range&) {
+            thrown = true;
+        }
+        if (!thrown || dynG.vertices[startNode].adj.size() != degree || dyn.distance(finishNode) != distance) {
+            cout << "Dynamic update batch validation mismatch\n";
+            return 1;
+        }
+    }
+
     /*G.saveToFile("graph.txt");
     system("pause");
     G.loadFromFile("graph.txt");
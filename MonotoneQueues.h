@@ -0,0 +1,413 @@
+//---------------------------------------------------------------------------------------------------------
+//  Монотонные очереди с приоритетами для целых весов рёбер - стратегии очереди для Dijkstra.
+//
+//  В алгоритме Дейкстры ключи извлекаемых вершин не убывают, а новые ключи не меньше последнего
+//  извлечённого (веса неотрицательны). Для целых весов этим можно воспользоваться:
+//    - dialQueue  - корзины Дейла: C корзин по кругу, C > максимального веса ребра. Все ключи в очереди
+//                   лежат в диапазоне [последний извлечённый, последний + maxWeight], так что корзина
+//                   ключа key - это key mod C. Добавление и уменьшение ключа - O(1), извлечение -
+//                   просмотр корзин вперёд (в сумме не больше C на каждое значение ключа). Корзин не
+//                   больше dialQueue::maxBuckets (2^24): при большем весе ребра attach бросает length_error;
+//    - radixHeap  - поразрядная куча: корзина элемента - номер старшего бита, в котором его ключ
+//                   отличается от последнего извлечённого. Уменьшение ключа - ленивое (старая запись
+//                   остаётся и пропускается при извлечении), элемент спускается по корзинам не больше
+//                   разрядности ключа раз.
+//    - autoQueue  - сама выбирает очередь при привязке к графу: для целых весов находит максимальный
+//                   вес ребра и берёт корзины Дейла, если корзин получается немного, иначе поразрядную
+//                   кучу; для нецелых весов - 4-арную кучу.
+//
+//  Каждая вершина попадает в очередь не больше одного раза за запрос (так работает Dijkstra).
+//
+//  Использование:  Dijkstra<vertex, autoQueue> dk(G);
+//---------------------------------------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include "DAryHeap.h"
+
+//  Номер старшего единичного бита (x > 0), считая с 1
+template<typename T>
+inline unsigned highestBit(T x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+	return static_cast<unsigned>(std::numeric_limits<unsigned long long>::digits) -
+		static_cast<unsigned>(__builtin_clzll(static_cast<unsigned long long>(x)));
+#else
+	unsigned bit = 0;
+	while (x != 0) {
+		x >>= 1;
+		++bit;
+	}
+	return bit;
+#endif
+}
+
+//  Максимальный вес ребра в графе, к которому привязаны обёртки вершин
+template<typename nodeType>
+typename nodeType::weight_type maxEdgeWeight(const std::vector<nodeType>& nodes) {
+	typename nodeType::weight_type result = 0;
+	for (const nodeType& node : nodes)
+		for (auto adjIt = node.vertex->cbegin(); adjIt != node.vertex->cend(); ++adjIt)
+			if (adjIt->weight > result)
+				result = adjIt->weight;
+	return result;
+}
+
+//---------------------------------------------------------------------------------------------------------
+//  Корзины Дейла. Корзина - двусвязный список вершин на массивах next/prev, так что
+//  перенос вершины в другую корзину при уменьшении ключа не требует памяти
+template<typename nodeType>
+class dialQueue {
+	using size_type = typename nodeType::size_type;
+	using weight_type = typename nodeType::weight_type;
+
+	static_assert(std::is_integral<weight_type>::value, "Dial buckets need integral edge weights");
+
+	static constexpr size_type npos = std::numeric_limits<size_type>::max();
+
+	//  Количество корзин - степень двойки, чтобы вместо деления брать маску
+	weight_type mask = 0;
+	std::vector<size_type> head;
+	std::vector<size_type> next;
+	std::vector<size_type> prev;
+	std::vector<weight_type> key;
+
+	//  Текущий минимальный ключ - корзины просматриваются начиная с него
+	mutable weight_type cursor = 0;
+	size_type count = 0;
+	//  Очередь только что очищена - первый добавленный ключ задаёт начало отсчёта
+	bool fresh = true;
+
+	inline void link(size_type id) noexcept {
+		size_type& first = head[key[id] & mask];
+		prev[id] = npos;
+		next[id] = first;
+		if (first != npos) prev[first] = id;
+		first = id;
+	}
+
+	inline void unlink(size_type id) noexcept {
+		if (prev[id] != npos) next[prev[id]] = next[id];
+		else head[key[id] & mask] = next[id];
+		if (next[id] != npos) prev[next[id]] = prev[id];
+	}
+
+	//  Продвигаем курсор до первой непустой корзины
+	inline void advance() const noexcept {
+		while (head[cursor & mask] == npos)
+			++cursor;
+	}
+
+public:
+	//  Предел количества корзин - при весах больше этого нужна поразрядная куча
+	static constexpr unsigned long long maxBuckets = 1ull << 24;
+
+	//  Привязка с явно известным максимальным весом ребра
+	void attach(std::vector<nodeType>& nodes, weight_type maxWeight) {
+		if (static_cast<unsigned long long>(maxWeight) >= maxBuckets)
+			throw std::length_error("Edge weight is too large for Dial buckets");
+		weight_type buckets = 1;
+		while (buckets <= maxWeight)
+			buckets <<= 1;
+		mask = buckets - 1;
+		head.assign(static_cast<size_t>(buckets), npos);
+		next.assign(nodes.size(), npos);
+		prev.assign(nodes.size(), npos);
+		key.assign(nodes.size(), 0);
+		cursor = 0;
+		count = 0;
+		fresh = true;
+	}
+
+	inline void attach(std::vector<nodeType>& nodes) { attach(nodes, maxEdgeWeight(nodes)); }
+
+	inline void push(size_type id, weight_type Key) noexcept {
+		if (fresh) {
+			cursor = Key;
+			fresh = false;
+		}
+		key[id] = Key;
+		link(id);
+		++count;
+	}
+
+	inline void decreaseKey(size_type id, weight_type Key) noexcept {
+		unlink(id);
+		key[id] = Key;
+		link(id);
+	}
+
+	//  Просеивания в корзинах нет - статистика получает только счётчики операций от Dijkstra
+	template<typename statsType>
+	inline void push(size_type id, weight_type Key, statsType&) noexcept { push(id, Key); }
+	template<typename statsType>
+	inline void decreaseKey(size_type id, weight_type Key, statsType&) noexcept { decreaseKey(id, Key); }
+	template<typename statsType>
+	inline void pop(statsType&) noexcept { pop(); }
+
+	inline size_type top() const noexcept {
+		advance();
+		return head[cursor & mask];
+	}
+
+	inline void pop() noexcept {
+		advance();
+		size_type id = head[cursor & mask];
+		unlink(id);
+		--count;
+	}
+
+	inline bool empty() const noexcept { return count == 0; }
+
+	inline void clear() noexcept {
+		fresh = true;
+		if (count == 0) return;
+		//  Оставшиеся элементы лежат не дальше чем в C корзинах от курсора
+		for (weight_type i = 0; i <= mask; ++i)
+			head[(cursor + i) & mask] = npos;
+		count = 0;
+	}
+};
+
+//---------------------------------------------------------------------------------------------------------
+//  Поразрядная куча (radix heap) с ленивым уменьшением ключа
+template<typename nodeType>
+class radixHeap {
+	using size_type = typename nodeType::size_type;
+	using weight_type = typename nodeType::weight_type;
+
+	static_assert(std::is_integral<weight_type>::value, "Radix heap needs integral edge weights");
+
+	struct item {
+		weight_type key;
+		size_type id;
+	};
+
+	//  Корзина 0 - ключи, равные последнему извлечённому, корзина b - старший отличающийся бит равен b
+	mutable std::vector<std::vector<item>> buckets;
+	//  Текущий ключ вершины и признак "вершина в очереди" - по ним отличаются устаревшие записи
+	std::vector<weight_type> key;
+	std::vector<char> queued;
+
+	mutable weight_type last = 0;
+	size_type count = 0;
+	bool fresh = true;
+
+	inline size_type bucketOf(weight_type Key) const noexcept {
+		return Key == last ? 0 : highestBit(Key ^ last);
+	}
+
+	inline bool stale(const item& x) const noexcept { return !queued[x.id] || key[x.id] != x.key; }
+
+	//  Добиваемся, чтобы в корзине 0 наверху лежала живая запись: берём первую непустую корзину,
+	//  её минимум становится новым last, и записи раскладываются по младшим корзинам
+	void normalize() const {
+		while (true) {
+			std::vector<item>& zero = buckets[0];
+			while (!zero.empty() && stale(zero.back()))
+				zero.pop_back();
+			if (!zero.empty()) return;
+
+			size_type b = 1;
+			while (buckets[b].empty())
+				++b;
+
+			std::vector<item>& source = buckets[b];
+			bool found = false;
+			for (const item& x : source)
+				if (!stale(x) && (!found || x.key < last)) {
+					last = x.key;
+					found = true;
+				}
+			for (const item& x : source)
+				if (!stale(x))
+					buckets[bucketOf(x.key)].push_back(x);
+			source.clear();
+		}
+	}
+
+public:
+	inline void attach(std::vector<nodeType>& nodes) {
+		buckets.assign(std::numeric_limits<weight_type>::digits + 1, std::vector<item>());
+		key.assign(nodes.size(), 0);
+		queued.assign(nodes.size(), 0);
+		last = 0;
+		count = 0;
+		fresh = true;
+	}
+
+	inline void push(size_type id, weight_type Key) {
+		//  Первый ключ после очистки задаёт начало отсчёта
+		if (fresh) {
+			last = Key;
+			fresh = false;
+		}
+		key[id] = Key;
+		queued[id] = 1;
+		buckets[bucketOf(Key)].push_back(item{ Key, id });
+		++count;
+	}
+
+	//  Старая запись остаётся в своей корзине и будет пропущена
+	inline void decreaseKey(size_type id, weight_type Key) {
+		key[id] = Key;
+		buckets[bucketOf(Key)].push_back(item{ Key, id });
+	}
+
+	//  Просеивания здесь нет (перераскладка корзин происходит в top) - статистика получает
+	//  только счётчики операций от Dijkstra
+	template<typename statsType>
+	inline void push(size_type id, weight_type Key, statsType&) { push(id, Key); }
+	template<typename statsType>
+	inline void decreaseKey(size_type id, weight_type Key, statsType&) { decreaseKey(id, Key); }
+	template<typename statsType>
+	inline void pop(statsType&) { pop(); }
+
+	inline size_type top() const {
+		normalize();
+		return buckets[0].back().id;
+	}
+
+	inline void pop() {
+		normalize();
+		queued[buckets[0].back().id] = 0;
+		buckets[0].pop_back();
+		--count;
+	}
+
+	inline bool empty() const noexcept { return count == 0; }
+
+	inline void clear() noexcept {
+		for (std::vector<item>& bucket : buckets) {
+			for (const item& x : bucket)
+				queued[x.id] = 0;
+			bucket.clear();
+		}
+		count = 0;
+		fresh = true;
+	}
+};
+
+//---------------------------------------------------------------------------------------------------------
+//  Автоматический выбор очереди по типу и диапазону весов
+template<typename nodeType>
+class autoQueue {
+	using size_type = typename nodeType::size_type;
+	using weight_type = typename nodeType::weight_type;
+
+	static constexpr bool integral = std::is_integral<weight_type>::value;
+
+	//  Для нецелых весов монотонные очереди не компилируются - на их месте стоит обычная куча
+	using dialType = typename std::conditional<integral, dialQueue<nodeType>, fourAryHeap<nodeType>>::type;
+	using radixType = typename std::conditional<integral, radixHeap<nodeType>, fourAryHeap<nodeType>>::type;
+
+	enum class kind { Dial, Radix, Heap };
+
+	kind mode = kind::Heap;
+	dialType dial;
+	radixType radix;
+	fourAryHeap<nodeType> heap;
+
+public:
+	//  Корзин Дейла не больше этого количества - иначе их просмотр и память обходятся дороже кучи
+	static constexpr unsigned long long dialLimit = 1ull << 16;
+
+	void attach(std::vector<nodeType>& nodes) {
+		if constexpr (integral) {
+			if (static_cast<unsigned long long>(maxEdgeWeight(nodes)) < dialLimit) {
+				mode = kind::Dial;
+				dial.attach(nodes);
+			}
+			else {
+				mode = kind::Radix;
+				radix.attach(nodes);
+			}
+		}
+		else {
+			mode = kind::Heap;
+			heap.attach(nodes);
+		}
+	}
+
+	//  Какая очередь выбрана - для отчётов
+	const char* name() const noexcept {
+		return mode == kind::Dial ? "dial" : mode == kind::Radix ? "radix" : "4-ary heap";
+	}
+
+	inline void push(size_type id, weight_type key) {
+		switch (mode) {
+		case kind::Dial: dial.push(id, key); break;
+		case kind::Radix: radix.push(id, key); break;
+		default: heap.push(id, key);
+		}
+	}
+
+	inline void decreaseKey(size_type id, weight_type key) {
+		switch (mode) {
+		case kind::Dial: dial.decreaseKey(id, key); break;
+		case kind::Radix: radix.decreaseKey(id, key); break;
+		default: heap.decreaseKey(id, key);
+		}
+	}
+
+	template<typename statsType>
+	inline void push(size_type id, weight_type key, statsType& stats) {
+		switch (mode) {
+		case kind::Dial: dial.push(id, key, stats); break;
+		case kind::Radix: radix.push(id, key, stats); break;
+		default: heap.push(id, key, stats);
+		}
+	}
+
+	template<typename statsType>
+	inline void decreaseKey(size_type id, weight_type key, statsType& stats) {
+		switch (mode) {
+		case kind::Dial: dial.decreaseKey(id, key, stats); break;
+		case kind::Radix: radix.decreaseKey(id, key, stats); break;
+		default: heap.decreaseKey(id, key, stats);
+		}
+	}
+
+	template<typename statsType>
+	inline void pop(statsType& stats) {
+		switch (mode) {
+		case kind::Dial: dial.pop(stats); break;
+		case kind::Radix: radix.pop(stats); break;
+		default: heap.pop(stats);
+		}
+	}
+
+	inline size_type top() const {
+		switch (mode) {
+		case kind::Dial: return dial.top();
+		case kind::Radix: return radix.top();
+		default: return heap.top();
+		}
+	}
+
+	inline void pop() {
+		switch (mode) {
+		case kind::Dial: dial.pop(); break;
+		case kind::Radix: radix.pop(); break;
+		default: heap.pop();
+		}
+	}
+
+	inline bool empty() const {
+		switch (mode) {
+		case kind::Dial: return dial.empty();
+		case kind::Radix: return radix.empty();
+		default: return heap.empty();
+		}
+	}
+
+	inline void clear() {
+		switch (mode) {
+		case kind::Dial: dial.clear(); break;
+		case kind::Radix: radix.clear(); break;
+		default: heap.clear();
+		}
+	}
+};
@@ -0,0 +1,351 @@
+//---------------------------------------------------------------------------------------------------------
+//  Конвейер обработки запросов для долгоживущего сервера (DijkstraServer.cpp).
+//
+//  Граф загружается один раз, запросы (старт, финиш) приходят потоком и расходятся по рабочим потокам.
+//  У каждого рабочего потока своё состояние поиска - собственный объект движка (например, Dijkstra),
+//  созданный один раз. Рабочий поток забирает из общей очереди сразу пачку запросов (до batchSize),
+//  так что блокировка берётся один раз на пачку, а не на запрос.
+//
+//  Запросы одного клиента - queryStream. Ответы отдаются в порядке запросов, но не дожидаясь конца
+//  пачки: как только готов ответ на самый ранний неотданный запрос, он и все готовые за ним сразу
+//  переходят в очередь вывода. Функцию вывода вызывает собственный поток вывода queryStream, так что
+//  рабочие потоки никогда не ждут ввода-вывода: клиент, который медленно читает ответы, задерживает
+//  только себя. Количество неотданных ответов ограничено maxPending - при переполнении submit ждёт,
+//  так что ни быстрый, ни медленный клиент не съест всю память.
+//
+//  serverCounters - счётчики для наблюдения: принято, отвечено, ошибки, пачки, задержка от приёма
+//  запроса до готовности ответа (гистограмма по степеням двойки микросекунд) и пропускная способность.
+//
+//  Использование:
+//    queryPipeline<csrGraph, Dijkstra<csrVertex, fourAryHeap>> pipeline(csr, 4);
+//    queryStream<...> stream(pipeline, [](const queryResponse<...>& r) { ... });
+//    stream.submit(queryRequest<...>{ ... });
+//    stream.finish();
+//---------------------------------------------------------------------------------------------------------
+
+#pragma once
+#include <map>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iostream>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+#include "Dijkstra.h"
+
+//  Счётчики сервера. Обновляются рабочими потоками без блокировок
+class serverCounters {
+public:
+	using clock = std::chrono::steady_clock;
+
+	//  Корзина i гистограммы задержек - от 2^(i-1) до 2^i микросекунд
+	static constexpr unsigned buckets = 32;
+
+	serverCounters() : started(clock::now()) {}
+
+	void countReceived() noexcept { ++received; }
+	void countBatch() noexcept { ++batches; }
+	void countCompleted(clock::time_point receivedAt, bool error) noexcept {
+		auto micros = static_cast<unsigned long long>(
+			std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - receivedAt).count());
+		++completed;
+		if (error) ++errors;
+		latencySum += micros;
+		unsigned long long previous = latencyMax.load();
+		while (micros > previous && !latencyMax.compare_exchange_weak(previous, micros)) {}
+		unsigned bucket = 0;
+		while (bucket + 1 < buckets && (1ull << bucket) <= micros)
+			++bucket;
+		++histogram[bucket];
+	}
+
+	//  Верхняя граница перцентиля задержки по гистограмме, микросекунды
+	unsigned long long latencyPercentile(double p) const noexcept {
+		unsigned long long total = completed.load();
+		if (total == 0) return 0;
+		unsigned long long rank = static_cast<unsigned long long>(p / 100.0 * total + 0.5), seen = 0;
+		for (unsigned i = 0; i < buckets; ++i) {
+			seen += histogram[i].load();
+			if (seen >= rank && seen > 0)
+				return i == 0 ? 0 : 1ull << i;
+		}
+		return latencyMax.load();
+	}
+
+	double uptimeSeconds() const noexcept { return std::chrono::duration<double>(clock::now() - started).count(); }
+
+	//  Одна строка "имя значение ..." - её отдаёт команда stats
+	std::string format(unsigned long long vertices) const {
+		std::ostringstream out;
+		const unsigned long long done = completed.load();
+		const double uptime = uptimeSeconds();
+		out << "vertices " << vertices << " received " << received.load() << " completed " << done
+			<< " errors " << errors.load() << " batches " << batches.load()
+			<< " uptime_s " << uptime << " throughput_qps " << (uptime > 0 ? done / uptime : 0)
+			<< " mean_us " << (done ? static_cast<double>(latencySum.load()) / done : 0)
+			<< " p50_us " << latencyPercentile(50) << " p99_us " << latencyPercentile(99)
+			<< " max_us " << latencyMax.load();
+		return out.str();
+	}
+
+private:
+	clock::time_point started;
+	std::atomic<unsigned long long> received{ 0 };
+	std::atomic<unsigned long long> completed{ 0 };
+	std::atomic<unsigned long long> errors{ 0 };
+	std::atomic<unsigned long long> batches{ 0 };
+	std::atomic<unsigned long long> latencySum{ 0 };
+	std::atomic<unsigned long long> latencyMax{ 0 };
+	std::atomic<unsigned long long> histogram[buckets] = {};
+};
+
+//  Запрос: путь из source в target, снимок счётчиков (stats) или нераспознанный запрос -
+//  два последних тоже идут по порядку с остальными, чтобы ответы не перепутались
+template<typename sizeT>
+struct queryRequest {
+	enum class kind { Path, Stats, Malformed };
+	kind type = kind::Path;
+	sizeT source = 0;
+	sizeT target = 0;
+};
+
+//  Ответ: путь и стоимость как у Dijkstra::calcPath (пустой путь - недостижимо), или текст
+//  ошибки / строка счётчиков
+template<typename sizeT, typename weightT>
+struct queryResponse {
+	bool ok = true;
+	std::vector<sizeT> path;
+	weightT cost = 0;
+	std::string text;
+};
+
+template<typename graphType, typename engineType>
+class queryStream;
+
+template<typename graphType, typename engineType>
+class queryPipeline {
+public:
+	using graph_type = graphType;
+	using engine_type = engineType;
+	//  Типы номеров и стоимостей - из результата calcPath движка
+	using result_type = decltype(std::declval<engineType&>().calcPath(0, 0));
+	using size_type = typename result_type::first_type::value_type;
+	using weight_type = typename result_type::second_type;
+	using request = queryRequest<size_type>;
+	using response = queryResponse<size_type, weight_type>;
+
+	//  threads == 0 - по количеству аппаратных потоков
+	queryPipeline(const graphType& Graph, unsigned threads = 0, size_t BatchSize = 64, size_t MaxPending = 65536) :
+		graph(Graph), batchSize(BatchSize ? BatchSize : 1), maxPending(MaxPending ? MaxPending : 1) {
+		if (threads == 0)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		for (unsigned t = 0; t < threads; ++t)
+			workers.emplace_back([this] { work(); });
+	}
+
+	queryPipeline(const queryPipeline&) = delete;
+	queryPipeline& operator=(const queryPipeline&) = delete;
+
+	~queryPipeline() {
+		{
+			std::lock_guard<std::mutex> lock(guard);
+			stopping = true;
+		}
+		hasWork.notify_all();
+		for (std::thread& w : workers)
+			w.join();
+	}
+
+	unsigned threads() const noexcept { return static_cast<unsigned>(workers.size()); }
+	const serverCounters& counters() const noexcept { return stats; }
+	std::string statsLine() const { return stats.format(static_cast<unsigned long long>(graph.size())); }
+
+private:
+	friend class queryStream<graphType, engineType>;
+
+	struct job {
+		queryStream<graphType, engineType>* stream;
+		unsigned long long seq;
+		request query;
+		serverCounters::clock::time_point receivedAt;
+	};
+
+	const graphType& graph;
+	const size_t batchSize;
+	const size_t maxPending;
+
+	std::mutex guard;
+	std::condition_variable hasWork;
+	std::condition_variable hasRoom;
+	std::deque<job> jobs;
+	bool stopping = false;
+
+	serverCounters stats;
+	std::vector<std::thread> workers;
+
+	void enqueue(job j) {
+		stats.countReceived();
+		{
+			std::unique_lock<std::mutex> lock(guard);
+			hasRoom.wait(lock, [this] { return jobs.size() < maxPending; });
+			jobs.push_back(std::move(j));
+		}
+		hasWork.notify_one();
+	}
+
+	void work() {
+		engineType engine(graph);
+		std::vector<job> batch;
+		batch.reserve(batchSize);
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(guard);
+				hasWork.wait(lock, [this] { return stopping || !jobs.empty(); });
+				if (jobs.empty())
+					return;
+				while (!jobs.empty() && batch.size() < batchSize) {
+					batch.push_back(std::move(jobs.front()));
+					jobs.pop_front();
+				}
+			}
+			hasRoom.notify_all();
+			stats.countBatch();
+
+			for (job& j : batch) {
+				response r;
+				if (j.query.type == request::kind::Stats)
+					r.text = statsLine();
+				else if (j.query.type == request::kind::Malformed) {
+					r.ok = false;
+					r.text = "malformed request";
+				}
+				else
+					try {
+						auto result = engine.calcPath(j.query.source, j.query.target);
+						r.path = std::move(result.first);
+						r.cost = result.second;
+					}
+					catch (const std::exception& e) {
+						r.ok = false;
+						r.text = e.what();
+					}
+				stats.countCompleted(j.receivedAt, !r.ok);
+				j.stream->complete(j.seq, std::move(r));
+			}
+			batch.clear();
+		}
+	}
+};
+
+//  Поток запросов одного клиента с выдачей ответов по порядку
+template<typename graphType, typename engineType>
+class queryStream {
+public:
+	using pipeline_type = queryPipeline<graphType, engineType>;
+	using request = typename pipeline_type::request;
+	using response = typename pipeline_type::response;
+
+	//  deliver вызывается из потока вывода этого объекта - по одному и строго в порядке запросов
+	queryStream(pipeline_type& Pipeline, std::function<void(const response&)> Deliver) :
+		pipeline(&Pipeline), deliver(std::move(Deliver)), writer([this] { write(); }) {}
+
+	queryStream(const queryStream&) = delete;
+	queryStream& operator=(const queryStream&) = delete;
+
+	~queryStream() {
+		finish();
+		{
+			std::lock_guard<std::mutex> lock(guard);
+			closing = true;
+		}
+		hasOutput.notify_one();
+		writer.join();
+	}
+
+	//  Ждёт, если у клиента уже maxPending неотданных ответов (иначе один медленный запрос или
+	//  медленный читатель копили бы за собой готовые ответы без ограничения)
+	void submit(const request& query) {
+		{
+			std::unique_lock<std::mutex> lock(guard);
+			progress.wait(lock, [this] { return submitted - delivered < pipeline->maxPending; });
+			++submitted;
+		}
+		pipeline->enqueue(typename pipeline_type::job{ this, nextSeq++, query, serverCounters::clock::now() });
+	}
+
+	//  Дождаться, пока будут отданы ответы на все принятые запросы
+	void finish() {
+		std::unique_lock<std::mutex> lock(guard);
+		progress.wait(lock, [this] { return delivered == submitted; });
+	}
+
+private:
+	friend class queryPipeline<graphType, engineType>;
+
+	pipeline_type* pipeline;
+	std::function<void(const response&)> deliver;
+
+	//  nextSeq меняет только поток, который читает запросы клиента
+	unsigned long long nextSeq = 0;
+
+	std::mutex guard;
+	//  Отданы очередные ответы - для submit и finish
+	std::condition_variable progress;
+	//  В очереди вывода появились ответы (или объект закрывается) - для потока вывода
+	std::condition_variable hasOutput;
+	unsigned long long submitted = 0;
+	unsigned long long delivered = 0;
+	//  Номер следующего ответа, который перейдёт в очередь вывода
+	unsigned long long nextOut = 0;
+	//  Готовые ответы, которые ждут более ранних
+	std::map<unsigned long long, response> ready;
+	//  Ответы по порядку, ещё не переданные deliver
+	std::deque<response> outbox;
+	bool closing = false;
+
+	//  Поток вывода - последним, чтобы он запускался после инициализации остальных полей
+	std::thread writer;
+
+	//  Вызывается рабочими потоками: только перекладывает ответы, сам вывод - в потоке вывода.
+	//  Будим поток вывода под блокировкой: как только её отпустим, последний ответ может быть отдан,
+	//  а объект разрушен - после этого трогать this нельзя
+	void complete(unsigned long long seq, response r) {
+		std::lock_guard<std::mutex> lock(guard);
+		ready.emplace(seq, std::move(r));
+		const unsigned long long before = nextOut;
+		for (auto it = ready.begin(); it != ready.end() && it->first == nextOut; it = ready.erase(it)) {
+			outbox.push_back(std::move(it->second));
+			++nextOut;
+		}
+		if (nextOut != before)
+			hasOutput.notify_one();
+	}
+
+	void write() {
+		std::deque<response> taken;
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(guard);
+				hasOutput.wait(lock, [this] { return closing || !outbox.empty(); });
+				if (outbox.empty())
+					return;
+				taken.swap(outbox);
+			}
+			for (const response& r : taken)
+				deliver(r);
+			{
+				std::lock_guard<std::mutex> lock(guard);
+				delivered += taken.size();
+			}
+			taken.clear();
+			progress.notify_all();
+		}
+	}
+};
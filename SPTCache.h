@@ -0,0 +1,185 @@
+//---------------------------------------------------------------------------------------------------------
+//  Кэш начал поиска по стартовой вершине - для запросов, которые часто идут из одних и тех же вершин
+//  (склады, узлы).
+//
+//  calcPath каждый раз начинает с нуля и выбрасывает всё, что закрыл. sptCache хранит для стартовой
+//  вершины начало поиска (searchPrefix из Dijkstra.h): закрытые вершины с расстояниями и родителями
+//  и границу - открытые вершины с текущими оценками. Следующий запрос из той же вершины:
+//    - цель уже закрыта (или поиск был доведён до конца) - ответ сразу из кэша (hit);
+//    - иначе поиск продолжается с сохранённой границы (resume), а не с нуля;
+//    - записи нет - обычный поиск (miss).
+//  Дополненное начало поиска кладётся обратно в кэш.
+//
+//  Размер кэша ограничен объёмом памяти (байты по searchPrefix::bytes), при переполнении выбрасываются
+//  давно не использовавшиеся записи (LRU). Записи неизменяемы и раздаются через shared_ptr, так что
+//  запросы из нескольких потоков безопасны: блокировка берётся только на поиск и замену записи, а
+//  вытесненная запись живёт, пока её кто-то читает.
+//
+//  Использование (кэш общий, CachedDijkstra - по одному на поток):
+//    sptCache<vertex::size_type, vertex::weight_type> cache(64 << 20);
+//    CachedDijkstra<vertex> dk(G, cache);
+//    auto path = dk.calcPath(start, finish);
+//    std::cout << cache.counters();
+//---------------------------------------------------------------------------------------------------------
+
+#pragma once
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <iostream>
+#include <unordered_map>
+#include "Dijkstra.h"
+
+//  Счётчики кэша (снимок)
+struct cacheCounters {
+	unsigned long long hits = 0;
+	unsigned long long resumes = 0;
+	unsigned long long misses = 0;
+	unsigned long long evictions = 0;
+	size_t entries = 0;
+	size_t bytes = 0;
+};
+
+inline std::ostream& operator<<(std::ostream& out, const cacheCounters& c) {
+	out << "hits " << c.hits << ", resumes " << c.resumes << ", misses " << c.misses
+		<< ", evictions " << c.evictions << ", entries " << c.entries << ", bytes " << c.bytes;
+	return out;
+}
+
+template<typename sizeT, typename weightT>
+class sptCache {
+public:
+	using size_type = sizeT;
+	using weight_type = weightT;
+	using prefix_type = searchPrefix<sizeT, weightT>;
+	using entry_ptr = std::shared_ptr<const prefix_type>;
+
+	explicit sptCache(size_t budgetBytes) : budget(budgetBytes) {}
+
+	sptCache(const sptCache&) = delete;
+	sptCache& operator=(const sptCache&) = delete;
+
+	size_t budgetBytes() const noexcept { return budget; }
+
+	//  Запись для стартовой вершины (nullptr, если её нет); найденная запись становится самой свежей
+	entry_ptr find(size_type source) {
+		std::lock_guard<std::mutex> lock(guard);
+		auto it = index.find(source);
+		if (it == index.end())
+			return nullptr;
+		lru.splice(lru.begin(), lru, it->second);
+		return *it->second;
+	}
+
+	//  Сохранение записи. Уже лежащая запись с не меньшим количеством закрытых вершин остаётся,
+	//  запись больше всего бюджета не сохраняется
+	void store(entry_ptr entry) {
+		const size_t size = entry->bytes();
+		if (size > budget)
+			return;
+		std::lock_guard<std::mutex> lock(guard);
+		auto it = index.find(entry->start);
+		if (it != index.end()) {
+			lru.splice(lru.begin(), lru, it->second);
+			if ((*it->second)->settled.size() >= entry->settled.size())
+				return;
+			used -= (*it->second)->bytes();
+			*it->second = std::move(entry);
+		}
+		else {
+			lru.push_front(std::move(entry));
+			index.emplace(lru.front()->start, lru.begin());
+		}
+		used += size;
+
+		while (used > budget) {
+			used -= lru.back()->bytes();
+			index.erase(lru.back()->start);
+			lru.pop_back();
+			++evictions;
+		}
+	}
+
+	void clear() {
+		std::lock_guard<std::mutex> lock(guard);
+		lru.clear();
+		index.clear();
+		used = 0;
+	}
+
+	//  Учёт результата запроса - вызывает CachedDijkstra
+	void countHit() noexcept { ++hits; }
+	void countResume() noexcept { ++resumes; }
+	void countMiss() noexcept { ++misses; }
+
+	cacheCounters counters() const {
+		cacheCounters result;
+		result.hits = hits;
+		result.resumes = resumes;
+		result.misses = misses;
+		std::lock_guard<std::mutex> lock(guard);
+		result.evictions = evictions;
+		result.entries = index.size();
+		result.bytes = used;
+		return result;
+	}
+
+private:
+	const size_t budget;
+	size_t used = 0;
+
+	mutable std::mutex guard;
+	//  Записи от самой свежей к самой старой, и поиск записи по стартовой вершине
+	std::list<entry_ptr> lru;
+	std::unordered_map<size_type, typename std::list<entry_ptr>::iterator> index;
+
+	std::atomic<unsigned long long> hits{ 0 };
+	std::atomic<unsigned long long> resumes{ 0 };
+	std::atomic<unsigned long long> misses{ 0 };
+	unsigned long long evictions = 0;
+};
+
+//  Dijkstra с общим кэшем начал поиска. Сам объект не потокобезопасен - по одному на поток
+template<typename vertexType, template<typename> class queuePolicy = binaryHeapQueue>
+class CachedDijkstra {
+public:
+	using size_type = typename graphVertex<vertexType>::size_type;
+	using weight_type = typename graphVertex<vertexType>::weight_type;
+	using cache_type = sptCache<size_type, weight_type>;
+
+	template<typename vertexCont>
+	CachedDijkstra(const vertexCont& cont, cache_type& Cache) : engine(cont), cache(&Cache), vertexCount(cont.size()) {}
+
+	//  Тот же контракт, что у Dijkstra::calcPath
+	std::pair<std::vector<size_type>, weight_type> calcPath(size_type startIndex, size_type finishIndex) {
+		if (startIndex >= vertexCount || finishIndex >= vertexCount)
+			throw std::out_of_range("Wrong start or finish node index!");
+
+		typename cache_type::entry_ptr entry = cache->find(startIndex);
+		if (entry && (entry->complete() || entry->find(finishIndex) != entry->npos)) {
+			cache->countHit();
+			settled = 0;
+			return entry->path(finishIndex);
+		}
+
+		typename cache_type::prefix_type fresh;
+		fresh.start = startIndex;
+		if (entry) cache->countResume();
+		else cache->countMiss();
+
+		auto result = engine.calcPathFrom(entry ? *entry : fresh, finishIndex);
+		settled = engine.settledCount() - (entry ? static_cast<size_type>(entry->settled.size()) : 0);
+		cache->store(std::make_shared<const typename cache_type::prefix_type>(engine.prefix()));
+		return result;
+	}
+
+	//  Вершины, закрытые последним запросом сверх взятых из кэша
+	size_type settledCount() const noexcept { return settled; }
+
+private:
+	Dijkstra<vertexType, queuePolicy> engine;
+	cache_type* cache;
+	size_type vertexCount;
+	size_type settled = 0;
+};
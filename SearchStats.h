@@ -0,0 +1,84 @@
+//---------------------------------------------------------------------------------------------------------
+//  Статистика поиска - стратегия для Dijkstra (третий параметр шаблона).
+//
+//    - noStats     - по умолчанию: все счётчики - пустые inline-функции, в цикле поиска от них ничего
+//                    не остаётся, а дополнительные аргументы очереди не передаются вовсе;
+//    - searchStats - считает операции очереди (push, pop, decreaseKey и шаги просеивания - на сколько
+//                    уровней сдвинулся элемент в куче), просмотренные рёбра, закрытые вершины, и отдельно
+//                    время поиска и время восстановления пути.
+//
+//  Статистика последнего запроса доступна через Dijkstra::stats(), можно также задать функцию,
+//  которая вызывается после каждого запроса. Статистики складываются оператором +=.
+//
+//  Использование:
+//    Dijkstra<vertex, fourAryHeap, searchStats> dk(G);
+//    searchStats total;
+//    dk.setStatsCallback([&total](const searchStats& s) { total += s; });
+//---------------------------------------------------------------------------------------------------------
+
+#pragma once
+#include <chrono>
+#include <iostream>
+
+//  Статистика выключена - ничего не считаем
+struct noStats {
+	static constexpr bool enabled = false;
+
+	inline void countPush() noexcept {}
+	inline void countPop() noexcept {}
+	inline void countDecreaseKey() noexcept {}
+	inline void countSiftStep() noexcept {}
+	inline void countEdge() noexcept {}
+	inline void countSettled() noexcept {}
+};
+
+//  Счётчики одного запроса (или суммы запросов)
+struct searchStats {
+	static constexpr bool enabled = true;
+
+	using clock = std::chrono::steady_clock;
+
+	unsigned long long queries = 0;
+	unsigned long long pushes = 0;
+	unsigned long long pops = 0;
+	unsigned long long decreaseKeys = 0;
+	//  Суммарное количество уровней, на которые сдвигались элементы кучи при просеивании
+	unsigned long long siftSteps = 0;
+	//  Просмотренные рёбра (попытки релаксации)
+	unsigned long long edgesRelaxed = 0;
+	unsigned long long verticesSettled = 0;
+	double searchSeconds = 0;
+	double pathSeconds = 0;
+
+	inline void countPush() noexcept { ++pushes; }
+	inline void countPop() noexcept { ++pops; }
+	inline void countDecreaseKey() noexcept { ++decreaseKeys; }
+	inline void countSiftStep() noexcept { ++siftSteps; }
+	inline void countEdge() noexcept { ++edgesRelaxed; }
+	inline void countSettled() noexcept { ++verticesSettled; }
+
+	void clear() noexcept { *this = searchStats(); }
+
+	searchStats& operator+=(const searchStats& other) noexcept {
+		queries += other.queries;
+		pushes += other.pushes;
+		pops += other.pops;
+		decreaseKeys += other.decreaseKeys;
+		siftSteps += other.siftSteps;
+		edgesRelaxed += other.edgesRelaxed;
+		verticesSettled += other.verticesSettled;
+		searchSeconds += other.searchSeconds;
+		pathSeconds += other.pathSeconds;
+		return *this;
+	}
+};
+
+inline searchStats operator+(searchStats lhs, const searchStats& rhs) noexcept { return lhs += rhs; }
+
+inline std::ostream& operator<<(std::ostream& out, const searchStats& s) {
+	out << "queries " << s.queries << ", pushes " << s.pushes << ", pops " << s.pops
+		<< ", decreaseKey " << s.decreaseKeys << ", sift steps " << s.siftSteps
+		<< ", edges " << s.edgesRelaxed << ", settled " << s.verticesSettled
+		<< ", search " << s.searchSeconds << " s, path " << s.pathSeconds << " s";
+	return out;
+}
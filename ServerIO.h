@@ -0,0 +1,173 @@
+//---------------------------------------------------------------------------------------------------------
+//  Ввод-вывод сервера запросов, клиента и генератора нагрузки: буферизованное чтение из дескриптора,
+//  запись целиком, сокеты Unix и двоичное кодирование.
+//
+//  Протоколы (одинаковые для stdin/stdout и сокета):
+//    - строчный: запрос "source target\n", ответ "cost v0 v1 ... vk\n" (вершины пути от source до target),
+//      "unreachable\n", если пути нет, "error текст\n" для некорректного запроса. Команда "stats\n" -
+//      ответ "stats имя значение ...\n" со счётчиками сервера (по порядку с остальными ответами);
+//    - двоичный: запрос - два 64-битных числа (source, target), ответ - 64-битная стоимость и 64-битное
+//      количество вершин пути, за ними сами вершины. Недостижимо - стоимость 2^64-1 и 0 вершин, ошибка -
+//      стоимость 2^64-1 и количество 2^64-1. Все числа - little-endian. Команды stats здесь нет -
+//      счётчики можно получить по строчному протоколу, а при завершении сервер печатает их в stderr.
+//
+//  Сокеты Unix (AF_UNIX) есть только на POSIX-системах; stdin/stdout работают везде.
+//---------------------------------------------------------------------------------------------------------
+
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <io.h>
+#define DIJKSTRA_UNIX_SOCKETS 0
+#else
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <cerrno>
+#define DIJKSTRA_UNIX_SOCKETS 1
+#endif
+
+//  Ответ "ошибка" и "недостижимо" в двоичном протоколе
+constexpr std::uint64_t binaryNone = ~std::uint64_t(0);
+
+//  Буферизованное чтение из дескриптора (файл, канал, сокет)
+class fdReader {
+public:
+	explicit fdReader(int Fd) : fd(Fd), buffer(1 << 16) {}
+
+	//  Строка без '\n' (и без '\r'); false - конец потока
+	bool readLine(std::string& line) {
+		line.clear();
+		while (true) {
+			if (pos == filled && !fill())
+				return !line.empty();
+			const char* begin = buffer.data() + pos;
+			const char* end = static_cast<const char*>(std::memchr(begin, '\n', filled - pos));
+			if (end == nullptr) {
+				line.append(begin, filled - pos);
+				pos = filled;
+				continue;
+			}
+			line.append(begin, end - begin);
+			pos += end - begin + 1;
+			if (!line.empty() && line.back() == '\r')
+				line.pop_back();
+			return true;
+		}
+	}
+
+	//  Ровно size байт; false - поток кончился раньше
+	bool readExact(void* data, size_t size) {
+		char* out = static_cast<char*>(data);
+		while (size > 0) {
+			if (pos == filled && !fill())
+				return false;
+			size_t chunk = std::min(size, filled - pos);
+			std::memcpy(out, buffer.data() + pos, chunk);
+			pos += chunk;
+			out += chunk;
+			size -= chunk;
+		}
+		return true;
+	}
+
+private:
+	int fd;
+	std::vector<char> buffer;
+	size_t pos = 0;
+	size_t filled = 0;
+
+	bool fill() {
+		while (true) {
+#if defined(_WIN32)
+			int got = _read(fd, buffer.data(), static_cast<unsigned>(buffer.size()));
+#else
+			ssize_t got = ::read(fd, buffer.data(), buffer.size());
+			if (got < 0 && errno == EINTR) continue;
+#endif
+			if (got <= 0) return false;
+			pos = 0;
+			filled = static_cast<size_t>(got);
+			return true;
+		}
+	}
+};
+
+//  Запись всего буфера; false - получатель закрыл соединение
+inline bool writeAll(int fd, const void* data, size_t size) {
+	const char* in = static_cast<const char*>(data);
+	while (size > 0) {
+#if defined(_WIN32)
+		int put = _write(fd, in, static_cast<unsigned>(size));
+#elif defined(MSG_NOSIGNAL)
+		//  send на сокете не роняет процесс сигналом SIGPIPE; для каналов и файлов - обычный write
+		ssize_t put = ::send(fd, in, size, MSG_NOSIGNAL);
+		if (put < 0 && errno == ENOTSOCK) put = ::write(fd, in, size);
+		if (put < 0 && errno == EINTR) continue;
+#else
+		ssize_t put = ::write(fd, in, size);
+		if (put < 0 && errno == EINTR) continue;
+#endif
+		if (put <= 0) return false;
+		in += put;
+		size -= static_cast<size_t>(put);
+	}
+	return true;
+}
+
+//  Двоичные числа - little-endian независимо от платформы
+inline void putU64(std::string& out, std::uint64_t value) {
+	for (int i = 0; i < 8; ++i)
+		out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+inline std::uint64_t getU64(const unsigned char* in) noexcept {
+	std::uint64_t value = 0;
+	for (int i = 7; i >= 0; --i)
+		value = (value << 8) | in[i];
+	return value;
+}
+
+#if DIJKSTRA_UNIX_SOCKETS
+inline sockaddr_un unixAddress(const std::string& path) {
+	sockaddr_un address;
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(address.sun_path))
+		throw std::invalid_argument("Socket path is too long: " + path);
+	std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+	return address;
+}
+
+//  Слушающий сокет; старый файл сокета по этому пути удаляется
+inline int listenUnix(const std::string& path) {
+	sockaddr_un address = unixAddress(path);
+	int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		throw std::runtime_error("Can't create socket");
+	::unlink(path.c_str());
+	if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || ::listen(fd, 16) < 0) {
+		::close(fd);
+		throw std::runtime_error("Can't listen on socket " + path);
+	}
+	return fd;
+}
+
+inline int connectUnix(const std::string& path) {
+	sockaddr_un address = unixAddress(path);
+	int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		throw std::runtime_error("Can't create socket");
+	if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+		::close(fd);
+		throw std::runtime_error("Can't connect to socket " + path);
+	}
+	return fd;
+}
+#endif
@@ -0,0 +1,313 @@
+//---------------------------------------------------------------------------------------------------------
+//  Dijkstra с векторизованной релаксацией рёбер (AVX2 / AVX-512, есть скалярный вариант).
+//
+//  В Dijkstra каждое ребро обрабатывается отдельно: ветвление по состоянию вершины, сравнение весов
+//  через обёртки graphVertex. Здесь рёбра вершины берутся прямо из CSR-массивов dests/weights
+//  (csrGraph или mappedGraph), а метки расстояний лежат в отдельном плотном массиве, так что за одну
+//  инструкцию обрабатывается 4 (AVX2) или 8 (AVX-512) рёбер:
+//    - загрузить номера соседей и веса рёбер;
+//    - собрать (gather) текущие оценки соседей;
+//    - кандидат = dist(u) + w, сравнить с оценкой;
+//    - "сжать" улучшающие дорожки - номера и кандидаты записываются подряд в буфер.
+//  Очередь трогается уже только для улучшений из буфера. Состояние вершин проверять не нужно: при
+//  неотрицательных весах у закрытой вершины оценка не больше dist(u), и улучшения для неё не будет.
+//
+//  Набор инструкций выбирается во время выполнения (detectSimdLevel), так что один исполняемый файл
+//  работает на любой x86-64 машине; можно и явно попросить более простой вариант. Векторные ядра есть
+//  только для 64-битных номеров и весов на x86-64 (GCC, Clang, MSVC), в остальных случаях - скалярное.
+//
+//  Использование:
+//    const csrGraph csr(G);
+//    SimdDijkstra dk(csr);
+//    auto path = dk.calcPath(start, finish);
+//---------------------------------------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <utility>
+#include <stdexcept>
+#include <algorithm>
+#include "CSRGraph.h"
+#include "DAryHeap.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define DIJKSTRA_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define DIJKSTRA_SIMD_TARGET(isa)
+#else
+#define DIJKSTRA_SIMD_TARGET(isa) __attribute__((target(isa)))
+#endif
+#else
+#define DIJKSTRA_SIMD_X86 0
+#endif
+
+enum class simdLevel { Scalar, AVX2, AVX512 };
+
+inline const char* simdLevelName(simdLevel level) noexcept {
+	switch (level) {
+	case simdLevel::AVX2: return "avx2";
+	case simdLevel::AVX512: return "avx512";
+	default: return "scalar";
+	}
+}
+
+//  Лучший набор инструкций, который поддерживают процессор и ОС
+inline simdLevel detectSimdLevel() noexcept {
+#if DIJKSTRA_SIMD_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) return simdLevel::Scalar;
+	__cpuid(info, 1);
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	if (!osxsave) return simdLevel::Scalar;
+	const unsigned long long xcr0 = _xgetbv(0);
+	__cpuidex(info, 7, 0);
+	if ((xcr0 & 0xE6) == 0xE6 && (info[1] & (1 << 16)))
+		return simdLevel::AVX512;
+	if ((xcr0 & 0x6) == 0x6 && (info[1] & (1 << 5)))
+		return simdLevel::AVX2;
+#else
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f"))
+		return simdLevel::AVX512;
+	if (__builtin_cpu_supports("avx2"))
+		return simdLevel::AVX2;
+#endif
+#endif
+	return simdLevel::Scalar;
+}
+
+namespace simdDetail {
+	//  Ядро релаксации: рёбра [0, count) вершины с расстоянием du. Улучшающие рёбра (номер соседа и кандидат)
+	//  записываются подряд в outDest/outDist, возвращается их количество. В буферах должно быть место
+	//  на count + 8 элементов - векторные ядра пишут вектор целиком
+	template<typename sizeT, typename weightT>
+	inline std::size_t relaxScalar(const sizeT* dests, const weightT* weights, std::size_t count, weightT du,
+		const weightT* dist, sizeT* outDest, weightT* outDist) noexcept {
+		std::size_t n = 0;
+		for (std::size_t i = 0; i < count; ++i) {
+			weightT candidate = du + weights[i];
+			if (candidate < dist[dests[i]]) {
+				outDest[n] = dests[i];
+				outDist[n] = candidate;
+				++n;
+			}
+		}
+		return n;
+	}
+
+#if DIJKSTRA_SIMD_X86
+	inline unsigned popCount(unsigned mask) noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+		return __popcnt(mask);
+#else
+		return static_cast<unsigned>(__builtin_popcount(mask));
+#endif
+	}
+
+	//  Перестановки 32-битных половин для сжатия 4 64-битных дорожек по маске: выбранные дорожки - в начало
+	struct compressTable {
+		alignas(32) int perm[16][8];
+		compressTable() noexcept {
+			for (int mask = 0; mask < 16; ++mask) {
+				int k = 0;
+				for (int lane = 0; lane < 4; ++lane)
+					if (mask & (1 << lane)) {
+						perm[mask][k++] = 2 * lane;
+						perm[mask][k++] = 2 * lane + 1;
+					}
+				while (k < 8)
+					perm[mask][k++] = 0;
+			}
+		}
+	};
+
+	inline const compressTable& compress4() noexcept {
+		static const compressTable table;
+		return table;
+	}
+
+	//  Беззнаковое сравнение 64-битных чисел в AVX2 - через знаковое после инверсии старшего бита
+	DIJKSTRA_SIMD_TARGET("avx2")
+	inline std::size_t relaxAVX2(const std::uint64_t* dests, const std::uint64_t* weights, std::size_t count,
+		std::uint64_t du, const std::uint64_t* dist, std::uint64_t* outDest, std::uint64_t* outDist) noexcept {
+		const compressTable& table = compress4();
+		const __m256i sign = _mm256_set1_epi64x(std::numeric_limits<long long>::min());
+		const __m256i base = _mm256_set1_epi64x(static_cast<long long>(du));
+		std::size_t i = 0, n = 0;
+		for (; i + 4 <= count; i += 4) {
+			__m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dests + i));
+			__m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+			__m256i current = _mm256_i64gather_epi64(reinterpret_cast<const long long*>(dist), d, 8);
+			__m256i candidate = _mm256_add_epi64(base, w);
+			__m256i better = _mm256_cmpgt_epi64(_mm256_xor_si256(current, sign), _mm256_xor_si256(candidate, sign));
+			unsigned mask = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(better)));
+			if (mask == 0) continue;
+			__m256i perm = _mm256_load_si256(reinterpret_cast<const __m256i*>(table.perm[mask]));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(outDest + n), _mm256_permutevar8x32_epi32(d, perm));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(outDist + n), _mm256_permutevar8x32_epi32(candidate, perm));
+			n += popCount(mask);
+		}
+		return n + relaxScalar(dests + i, weights + i, count - i, du, dist, outDest + n, outDist + n);
+	}
+
+	DIJKSTRA_SIMD_TARGET("avx512f")
+	inline std::size_t relaxAVX512(const std::uint64_t* dests, const std::uint64_t* weights, std::size_t count,
+		std::uint64_t du, const std::uint64_t* dist, std::uint64_t* outDest, std::uint64_t* outDist) noexcept {
+		const __m512i base = _mm512_set1_epi64(static_cast<long long>(du));
+		std::size_t i = 0, n = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m512i d = _mm512_loadu_si512(dests + i);
+			__m512i w = _mm512_loadu_si512(weights + i);
+			__m512i current = _mm512_mask_i64gather_epi64(_mm512_setzero_si512(), 0xFF, d, dist, 8);
+			__m512i candidate = _mm512_add_epi64(base, w);
+			__mmask8 mask = _mm512_cmplt_epu64_mask(candidate, current);
+			if (mask == 0) continue;
+			_mm512_mask_compressstoreu_epi64(outDest + n, mask, d);
+			_mm512_mask_compressstoreu_epi64(outDist + n, mask, candidate);
+			n += popCount(mask);
+		}
+		return n + relaxScalar(dests + i, weights + i, count - i, du, dist, outDest + n, outDist + n);
+	}
+#endif
+}
+
+class SimdDijkstra {
+public:
+	using size_type = csrView::size_type;
+	using weight_type = csrView::weight_type;
+
+	//  Граф - любой с CSR-массивами (csrGraph, mappedGraph); level - какой набор инструкций использовать,
+	//  если процессор его не поддерживает, то берётся лучший из доступных
+	template<typename csrCont>
+	explicit SimdDijkstra(const csrCont& cont, simdLevel level = detectSimdLevel()) : view(cont.arrays()) {
+		const simdLevel available = detectSimdLevel();
+		isa = static_cast<int>(level) <= static_cast<int>(available) ? level : available;
+		if (!vectorizable)
+			isa = simdLevel::Scalar;
+
+		dist.assign(view.vertexCount, infinity);
+		parent.assign(view.vertexCount, npos);
+		labels.resize(view.vertexCount);
+		epq.attach(labels);
+
+		size_type maxDegree = 0;
+		for (size_type i = 0; i < view.vertexCount; ++i)
+			maxDegree = std::max(maxDegree, view.offsets[i + 1] - view.offsets[i]);
+		improvedDest.resize(maxDegree + 8);
+		improvedDist.resize(maxDegree + 8);
+	}
+
+	simdLevel level() const noexcept { return isa; }
+
+	size_type settledCount() const noexcept { return settled; }
+
+	//  Тот же контракт, что у Dijkstra::calcPath
+	std::pair<std::vector<size_type>, weight_type> calcPath(size_type startIndex, size_type finishIndex) {
+		if (startIndex >= view.vertexCount || finishIndex >= view.vertexCount)
+			throw std::out_of_range("Wrong start or finish node index!");
+
+		reset();
+		settled = 0;
+		dist[startIndex] = 0;
+		parent[startIndex] = startIndex;
+		touched.push_back(startIndex);
+		epq.push(startIndex, 0);
+
+		while (!epq.empty()) {
+			size_type u = epq.top();
+			epq.pop();
+			//  Целевую вершину не считаем - как Dijkstra::settledCount, где она не отмечается закрытой
+			if (u == finishIndex)
+				break;
+			++settled;
+
+			const size_type first = view.offsets[u];
+			const std::size_t n = relax(view.dests + first, view.weights + first, view.offsets[u + 1] - first, dist[u]);
+			for (std::size_t k = 0; k < n; ++k) {
+				size_type v = improvedDest[k];
+				weight_type candidate = improvedDist[k];
+				//  Повторное ребро в тот же вектор могло уже улучшить оценку
+				if (!(candidate < dist[v])) continue;
+				if (dist[v] == infinity) {
+					touched.push_back(v);
+					epq.push(v, candidate);
+				}
+				else
+					epq.decreaseKey(v, candidate);
+				dist[v] = candidate;
+				parent[v] = u;
+			}
+		}
+
+		if (dist[finishIndex] == infinity)
+			return make_pair(std::vector<size_type>(), weight_type(0));
+
+		std::vector<size_type> path;
+		size_type nodeIndex(finishIndex);
+		path.push_back(nodeIndex);
+		while (nodeIndex != startIndex) {
+			nodeIndex = parent[nodeIndex];
+			path.push_back(nodeIndex);
+		}
+		std::reverse(path.begin(), path.end());
+		return make_pair(path, dist[finishIndex]);
+	}
+
+private:
+	static constexpr size_type npos = std::numeric_limits<size_type>::max();
+	static constexpr weight_type infinity = std::numeric_limits<weight_type>::max();
+	static constexpr bool vectorizable = DIJKSTRA_SIMD_X86 && sizeof(size_type) == 8 && sizeof(weight_type) == 8;
+
+	//  Для кучи нужны только типы; сами оценки - в плотном массиве dist
+	struct label {
+		using size_type = SimdDijkstra::size_type;
+		using weight_type = SimdDijkstra::weight_type;
+	};
+
+	csrView view;
+	simdLevel isa = simdLevel::Scalar;
+
+	std::vector<weight_type> dist;
+	std::vector<size_type> parent;
+	std::vector<label> labels;
+	fourAryHeap<label> epq;
+	std::vector<size_type> touched;
+	size_type settled = 0;
+
+	std::vector<size_type> improvedDest;
+	std::vector<weight_type> improvedDist;
+
+	void reset() noexcept {
+		for (size_type index : touched) {
+			dist[index] = infinity;
+			parent[index] = npos;
+		}
+		touched.clear();
+		epq.clear();
+	}
+
+	std::size_t relax(const size_type* dests, const weight_type* weights, std::size_t count, weight_type du) noexcept {
+#if DIJKSTRA_SIMD_X86
+		if constexpr (vectorizable) {
+			using u64 = std::uint64_t;
+			switch (isa) {
+			case simdLevel::AVX512:
+				return simdDetail::relaxAVX512(reinterpret_cast<const u64*>(dests), reinterpret_cast<const u64*>(weights), count,
+					du, reinterpret_cast<const u64*>(dist.data()), reinterpret_cast<u64*>(improvedDest.data()), reinterpret_cast<u64*>(improvedDist.data()));
+			case simdLevel::AVX2:
+				return simdDetail::relaxAVX2(reinterpret_cast<const u64*>(dests), reinterpret_cast<const u64*>(weights), count,
+					du, reinterpret_cast<const u64*>(dist.data()), reinterpret_cast<u64*>(improvedDest.data()), reinterpret_cast<u64*>(improvedDist.data()));
+			default:
+				break;
+			}
+		}
+#endif
+		return simdDetail::relaxScalar(dests, weights, count, du, dist.data(), improvedDest.data(), improvedDist.data());
+	}
+};